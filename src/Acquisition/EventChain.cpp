@@ -0,0 +1,42 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file EventChain.cpp
+** @author James Till Matta
+** @date 21 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the EventChain class
+**
+********************************************************************************
+*******************************************************************************/
+#include"EventChain.h"
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+
+namespace Acquisition
+{
+
+EventChain::EventChain(const std::string& outFile, int moduleNumber, int channelStartInd,
+                       const Filter::ChainConfig* config) :
+    writer(outFile), reducer(&writer),
+    coincidence(&reducer, Filter::DefaultCoincBufferSize), spectra(&coincidence),
+    sorter(&spectra, Filter::DefaultSortBufferSize, Filter::DefaultSortWindow),
+    parser(&sorter, moduleNumber, channelStartInd)
+{
+    if(config != nullptr)
+    {
+        config->applyTo(reducer);
+        config->applyTo(coincidence);
+    }
+}
+
+}
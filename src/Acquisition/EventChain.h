@@ -0,0 +1,74 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file EventChain.h
+** @author James Till Matta
+** @date 21 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the EventChain class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_ACQUISITION_EVENTCHAIN_H
+#define ORCHID_SRC_ACQUISITION_EVENTCHAIN_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+// includes from other libraries
+// includes from ORCHID
+#include"Events/DppPsdParser.h"
+#include"Filter/ChainConfig.h"
+#include"Filter/ChannelReducer.h"
+#include"Filter/CoincidenceFilter.h"
+#include"Filter/TimeSorter.h"
+#include"Output/EventFileWriter.h"
+#include"Output/OnlineSpectra.h"
+
+namespace Acquisition
+{
+
+//The stages one board's events go through, in order:
+//  parser -> time ordering -> spectra -> coincidence filter -> reducer -> writer
+//  the spectra see every event, the filter and reducer only decide what is
+//  written, with no config (or one that sets nothing) everything is written
+//Every stage allocates and pages in its buffers when it is built, so whoever
+//  builds the chain decides which node the memory lands on, the processing
+//  thread builds it after pinning itself
+class EventChain
+{
+public:
+    //config may be nullptr
+    EventChain(const std::string& outFile, int moduleNumber, int channelStartInd,
+               const Filter::ChainConfig* config);
+    ~EventChain(){}
+
+    //pushes everything still held in the sorter and filter out to the file
+    void flush(){sorter.flush();}
+
+    Events::DppPsdParser& getParser(){return parser;}
+    Filter::TimeSorter& getSorter(){return sorter;}
+    Filter::CoincidenceFilter& getCoincidenceFilter(){return coincidence;}
+    Filter::ChannelReducer& getReducer(){return reducer;}
+    Output::OnlineSpectra& getSpectra(){return spectra;}
+    Output::EventFileWriter& getWriter(){return writer;}
+
+private:
+    //built in this order, each stage is handed the one after it
+    Output::EventFileWriter writer;
+    Filter::ChannelReducer reducer;
+    Filter::CoincidenceFilter coincidence;
+    Output::OnlineSpectra spectra;
+    Filter::TimeSorter sorter;
+    Events::DppPsdParser parser;
+};
+
+}
+
+#endif //ORCHID_SRC_ACQUISITION_EVENTCHAIN_H
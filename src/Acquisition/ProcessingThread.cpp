@@ -0,0 +1,240 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ProcessingThread.cpp
+** @author James Till Matta
+** @date 19 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the ProcessingThread class
+**
+********************************************************************************
+*******************************************************************************/
+#include"ProcessingThread.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+#include<boost/chrono.hpp>
+// includes from ORCHID
+#include"Metrics/MetricsRegistry.h"
+#include"Utility/AllocationTracker.h"
+#include"Utility/ThreadPlacement.h"
+
+namespace Acquisition
+{
+
+enum {IdleSleepUs = 100};
+
+ProcessingThread::ProcessingThread(const std::string& outFile, const Filter::ChainConfig* config,
+                                   int boardNumber, int firstChannel, int bufferSizeInts) :
+    outFileName(outFile), chainConfig(config), moduleNumber(boardNumber),
+    channelStartInd(firstChannel), chain(nullptr), buffers(),
+    bufferSize(bufferSizeInts), freeBuffers(), items(), stopRequested(false),
+    abortRequested(false), failed(false), chainReady(false),
+    eventsParsed(0), bufferWaits(0), cpu(-1), procThread(nullptr), warmUpTime(5.0),
+    warmedUp(false), steadyStateAllocs(0), bufferWaitsMetric(nullptr),
+    queueDepthMetric(nullptr), lg(OrchidLog::get())
+{
+    std::ostringstream labels;
+    labels << "board=\"" << boardNumber << "\"";
+    Metrics::MetricsRegistry& registry = Metrics::MetricsRegistry::get();
+    bufferWaitsMetric = registry.addCounter("orchid_readout_buffer_waits_total", "Times the readout waited for the processing thread to free a transfer buffer", labels.str());
+    queueDepthMetric = registry.addGauge("orchid_processing_queue_items", "Transfers and register changes waiting for the processing thread", labels.str());
+    //paged in now, on the readout thread's node, rather than by the first transfers
+    for(int i=0; i<TransferBufferCount; ++i)
+    {
+        buffers[i] = reinterpret_cast<unsigned int*>(Utility::ThreadPlacement::allocateLocalBuffer(sizeof(unsigned int) * static_cast<std::size_t>(bufferSize)));
+        freeBuffers.push(i);
+    }
+}
+
+ProcessingThread::~ProcessingThread()
+{
+    //if the readout is unwinding it never called stop, so do not try to
+    //finish the queue, just get the thread out of the way
+    if(procThread != nullptr)
+    {
+        abortRequested.store(true);
+        procThread->join();
+        delete procThread;
+        procThread = nullptr;
+    }
+    for(int i=0; i<TransferBufferCount; ++i)
+    {
+        delete[] reinterpret_cast<char*>(buffers[i]);
+    }
+    delete chain;
+}
+
+void ProcessingThread::start()
+{
+    stopRequested.store(false);
+    abortRequested.store(false);
+    failed.store(false);
+    chainReady.store(false);
+    procThread = new boost::thread(&ProcessingThread::processLoop, this);
+    //the readout must not start the board until there is a chain to take its data
+    while(!chainReady.load() && !failed.load())
+    {
+        boost::this_thread::sleep_for(boost::chrono::microseconds(IdleSleepUs));
+    }
+    if(!chainReady.load())
+    {
+        procThread->join();
+        delete procThread;
+        procThread = nullptr;
+        BOOST_LOG_SEV(lg, Error) << "Processing Thread: Could Not Build The Event Chain For Digitizer #" << moduleNumber;
+        throw std::runtime_error("ProcessingThread Error - Could Not Build Event Chain");
+    }
+}
+
+void ProcessingThread::stop()
+{
+    if(procThread != nullptr)
+    {
+        stopRequested.store(true);
+        procThread->join();
+        delete procThread;
+        procThread = nullptr;
+    }
+}
+
+unsigned int* ProcessingThread::acquireBuffer(int& index)
+{
+    if(freeBuffers.pop(index))
+    {
+        return buffers[index];
+    }
+    ++bufferWaits;
+    bufferWaitsMetric->add(1);
+    while(!freeBuffers.pop(index))
+    {
+        if(failed.load())
+        {
+            return nullptr;
+        }
+        boost::this_thread::yield();
+    }
+    return buffers[index];
+}
+
+void ProcessingThread::submitBuffer(int index, int sizeInInts)
+{
+    ProcessItem item;
+    item.wallTime = 0;
+    item.bufferIndex = index;
+    item.sizeInInts = sizeInInts;
+    this->pushItem(item);
+}
+
+void ProcessingThread::submitUpdate(const Digitizer::LiveRegisterUpdate& update, unsigned long long wallTime)
+{
+    ProcessItem item;
+    item.update = update;
+    item.wallTime = wallTime;
+    item.bufferIndex = -1;
+    item.sizeInInts = 0;
+    this->pushItem(item);
+}
+
+void ProcessingThread::pushItem(const ProcessItem& item)
+{
+    //there are more slots than buffers, so only a burst of register changes
+    //can fill the queue, and that drains as fast as markers can be written
+    while(!items.push(item))
+    {
+        if(failed.load())
+        {
+            return;
+        }
+        boost::this_thread::yield();
+    }
+}
+
+void ProcessingThread::processLoop()
+{
+    typedef boost::chrono::steady_clock Clock;
+    Utility::ThreadPlacement::pinCallingThread(cpu);
+    try
+    {
+        //built here, after the pin, so every stage's buffers are first touched
+        //on this thread's node
+        if(chain == nullptr)
+        {
+            chain = new EventChain(outFileName, moduleNumber, channelStartInd, chainConfig);
+        }
+        chainReady.store(true);
+        Clock::time_point startTime = Clock::now();
+        unsigned long long allocsAtWarmUp = 0;
+        warmedUp = false;
+        steadyStateAllocs = 0;
+        ProcessItem item;
+        while(!abortRequested.load())
+        {
+            if(!warmedUp && (boost::chrono::duration<double>(Clock::now() - startTime).count() >= warmUpTime))
+            {
+                warmedUp = true;
+                allocsAtWarmUp = Utility::AllocationTracker::threadAllocations();
+            }
+            if(items.pop(item))
+            {
+                this->processItem(item);
+                queueDepthMetric->set(static_cast<double>(items.read_available()));
+                continue;
+            }
+            if(stopRequested.load())
+            {
+                //the readout pushes nothing after asking to stop, so anything
+                //that landed between the pop and the check is all that is left
+                while(items.pop(item))
+                {
+                    this->processItem(item);
+                }
+                break;
+            }
+            boost::this_thread::sleep_for(boost::chrono::microseconds(IdleSleepUs));
+        }
+        if(warmedUp)
+        {
+            steadyStateAllocs = (Utility::AllocationTracker::threadAllocations() - allocsAtWarmUp);
+        }
+        if(!abortRequested.load())
+        {
+            chain->flush();
+        }
+        queueDepthMetric->set(0.0);
+    }
+    catch(std::exception& ex)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Processing Thread: Stopped By Exception: " << ex.what();
+        failed.store(true);
+    }
+}
+
+void ProcessingThread::processItem(const ProcessItem& item)
+{
+    if(item.bufferIndex < 0)
+    {
+        //everything parsed so far was read before the change went to the board
+        chain->getWriter().writeConfigChange(item.update.channel, item.update.address, item.update.value, item.wallTime, chain->getParser().getLatestTimeStamp());
+        return;
+    }
+    if(item.sizeInInts > 0)
+    {
+        chain->getParser().parseBuffer(buffers[item.bufferIndex], item.sizeInInts);
+        eventsParsed.store(chain->getParser().getEventsParsed(), std::memory_order_relaxed);
+    }
+    //only this thread pushes onto the free queue and it has room for every
+    //buffer, so this cannot fail
+    freeBuffers.push(item.bufferIndex);
+}
+
+}
@@ -0,0 +1,136 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ProcessingThread.h
+** @author James Till Matta
+** @date 19 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the ProcessingThread class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_ACQUISITION_PROCESSINGTHREAD_H
+#define ORCHID_SRC_ACQUISITION_PROCESSINGTHREAD_H
+// includes for C system headers
+// includes for C++ system headers
+#include<atomic>
+#include<string>
+// includes from other libraries
+#include<boost/thread.hpp>
+#include<boost/lockfree/spsc_queue.hpp>
+// includes from ORCHID
+#include"Digitizer/LiveRegisterUpdate.h"
+#include"Filter/ChainConfig.h"
+#include"Metrics/Metric.h"
+#include"Utility/OrchidLogger.h"
+#include"EventChain.h"
+
+namespace Acquisition
+{
+
+enum {TransferBufferCount = 4, ProcessQueueSize = 256};
+
+//an entry on the queue from the readout thread, either a filled transfer
+//buffer or a register change that went to the board between transfers, both
+//go through the one queue so a change marker lands in the output after the
+//events read before it
+struct ProcessItem
+{
+    Digitizer::LiveRegisterUpdate update;
+    unsigned long long wallTime;
+    int bufferIndex;    //-1 for a register change
+    int sizeInInts;
+};
+
+//Parses, sorts, filters and writes the block transfers a readout loop pulls,
+//  on its own thread, so the readout thread only talks to the board
+//The event chain is built by the thread itself the first time it starts,
+//  after it has pinned itself, so the writer buffer, the sorter heap, the
+//  filter ring and the spectra are paged in on the processing node rather
+//  than the readout node
+//The transfer buffers are allocated and paged in when this is built and cycle
+//  between the two threads through a pair of wait free queues, if every buffer
+//  is waiting to be parsed the readout waits for one (and counts the wait)
+//  rather than allocating another
+//If anything in the chain throws the thread logs it, marks itself failed and
+//  exits, the readout side sees that the next time it asks for a buffer
+class ProcessingThread
+{
+public:
+    //config may be nullptr, it must outlive the first call to start
+    ProcessingThread(const std::string& outFile, const Filter::ChainConfig* config,
+                     int boardNumber, int firstChannel, int bufferSizeInts);
+    ~ProcessingThread();
+
+    //the cpu the thread pins itself to, -1 (the default) for any
+    void setCpu(int cpuNum){cpu = cpuNum;}
+    void setWarmUpTime(double seconds){warmUpTime = seconds;}
+    //returns once the chain is built, throws if building it failed
+    void start();
+    //processes everything already queued, flushes the chain, then joins
+    void stop();
+
+    //readout side, waits for a free buffer, returns nullptr if the thread failed
+    unsigned int* acquireBuffer(int& index);
+    void submitBuffer(int index, int sizeInInts);
+    void submitUpdate(const Digitizer::LiveRegisterUpdate& update, unsigned long long wallTime);
+    int getBufferSize(){return bufferSize;}
+    bool getFailed(){return failed.load();}
+    //readout side probes, how far the processing is behind the readout
+    int getQueuedItems(){return (ProcessQueueSize - static_cast<int>(items.write_available()));}
+    int getFreeBuffers(){return static_cast<int>(freeBuffers.read_available());}
+    unsigned long long getBufferWaits(){return bufferWaits;}
+    //safe from any thread, updated after each transfer is parsed
+    unsigned long long getEventsParsed(){return eventsParsed.load(std::memory_order_relaxed);}
+    //nullptr until the first start, only touch it while the thread is stopped
+    EventChain* getChain(){return chain;}
+
+    //only meaningful once the thread has been stopped
+    bool getWarmedUp(){return warmedUp;}
+    unsigned long long getSteadyStateAllocations(){return steadyStateAllocs;}
+
+private:
+    void processLoop();
+    void processItem(const ProcessItem& item);
+    void pushItem(const ProcessItem& item);
+
+    typedef boost::lockfree::spsc_queue<int, boost::lockfree::capacity<TransferBufferCount> > FreeBufferQueue;
+    typedef boost::lockfree::spsc_queue<ProcessItem, boost::lockfree::capacity<ProcessQueueSize> > ItemQueue;
+
+    std::string outFileName;
+    const Filter::ChainConfig* chainConfig;
+    int moduleNumber;
+    int channelStartInd;
+    EventChain* chain;
+    unsigned int* buffers[TransferBufferCount];
+    int bufferSize;
+    FreeBufferQueue freeBuffers;
+    ItemQueue items;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> abortRequested;
+    std::atomic<bool> failed;
+    std::atomic<bool> chainReady;
+    std::atomic<unsigned long long> eventsParsed;
+    unsigned long long bufferWaits;
+    int cpu;
+    boost::thread* procThread;
+    double warmUpTime;
+    bool warmedUp;
+    unsigned long long steadyStateAllocs;
+    //times the readout found every buffer still waiting to be parsed
+    Metrics::MetricCounter* bufferWaitsMetric;
+    Metrics::MetricGauge* queueDepthMetric;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_ACQUISITION_PROCESSINGTHREAD_H
@@ -0,0 +1,220 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ReadoutLoop.cpp
+** @author James Till Matta
+** @date 18 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the ReadoutLoop class
+**
+********************************************************************************
+*******************************************************************************/
+#include"ReadoutLoop.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+#include<boost/chrono.hpp>
+// includes from ORCHID
+#include"Metrics/MetricsRegistry.h"
+#include"Utility/AllocationTracker.h"
+
+namespace Acquisition
+{
+
+enum {ReadBufferInts = (4*1024*1024)};
+//idle polls made back to back before the loop starts sleeping between them,
+//and the longest sleep, the same as the processing thread's idle sleep
+enum {IdleSpinPolls = 16, MaxIdleSleepUs = 100};
+
+static const unsigned int ReadoutStatusEventReadyBit = 0x00000001;
+
+ReadoutLoop::ReadoutLoop(Digitizer::Vx1730Digitizer* digitizer, const std::string& outFile,
+                         const Filter::ChainConfig* chainConfig, Digitizer::LiveUpdateQueue* updateQueue) :
+    digi(digitizer), queue(updateQueue),
+    processor(outFile, chainConfig, digitizer->getModuleNumber(), digitizer->getChannelStartInd(), ReadBufferInts),
+    readBufferSize(ReadBufferInts),
+    appliedUpdates(), running(false), boardRunning(false), bytesRead(0), idleStreak(0), idleSleepUs(0),
+    warmUpTime(5.0), warmedUp(false),
+    steadyStateAllocs(0), idlePollsMetric(nullptr),
+    liveUpdatesMetric(nullptr), bufferFillMetric(nullptr), lg(OrchidLog::get())
+{
+    std::ostringstream labels;
+    labels << "board=\"" << digi->getModuleNumber() << "\"";
+    Metrics::MetricsRegistry& registry = Metrics::MetricsRegistry::get();
+    idlePollsMetric = registry.addCounter("orchid_readout_idle_polls_total", "Readout polls that found no data ready", labels.str());
+    liveUpdatesMetric = registry.addCounter("orchid_live_updates_total", "Register changes applied while acquiring", labels.str());
+    bufferFillMetric = registry.addGauge("orchid_readout_buffer_fill_ratio", "Fraction of the readout buffer used by the last transfer", labels.str());
+}
+
+ReadoutLoop::~ReadoutLoop()
+{
+}
+
+void ReadoutLoop::run(double seconds)
+{
+    typedef boost::chrono::steady_clock Clock;
+    this->begin();
+    try
+    {
+        Clock::time_point startTime = Clock::now();
+        double elapsed = 0.0;
+        unsigned long long allocsAtWarmUp = 0;
+        warmedUp = false;
+        steadyStateAllocs = 0;
+        while(running.load() && (elapsed < seconds))
+        {
+            if(!warmedUp && (elapsed >= warmUpTime))
+            {
+                warmedUp = true;
+                allocsAtWarmUp = Utility::AllocationTracker::threadAllocations();
+            }
+            this->poll();
+            elapsed = boost::chrono::duration<double>(Clock::now() - startTime).count();
+        }
+        if(warmedUp)
+        {
+            steadyStateAllocs = (Utility::AllocationTracker::threadAllocations() - allocsAtWarmUp);
+        }
+        this->end();
+    }
+    catch(...)
+    {
+        this->abort();
+        throw;
+    }
+    warmedUp = (warmedUp && processor.getWarmedUp());
+    steadyStateAllocs += processor.getSteadyStateAllocations();
+    BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Read " << bytesRead << " Bytes And " << processor.getEventsParsed() << " Events From Digitizer #" << digi->getModuleNumber();
+}
+
+void ReadoutLoop::begin()
+{
+    running.store(true);
+    idleStreak = 0;
+    idleSleepUs = 0;
+    processor.setWarmUpTime(warmUpTime);
+    processor.start();
+    digi->startAcquisition();
+    boardRunning = true;
+}
+
+bool ReadoutLoop::poll()
+{
+    //live changes go in between transfers so they never split one
+    if(queue != nullptr)
+    {
+        int applied = digi->applyLiveUpdates(*queue, appliedUpdates, MaxUpdatesPerPass);
+        if(applied > 0)
+        {
+            liveUpdatesMetric->add(static_cast<unsigned long long>(applied));
+            this->recordUpdates(applied);
+        }
+    }
+    if((digi->readReadoutStatus() & ReadoutStatusEventReadyBit) != 0)
+    {
+        this->readAndSubmit();
+        idleStreak = 0;
+        idleSleepUs = 0;
+        return true;
+    }
+    idlePollsMetric->add(1);
+    this->idleBackOff();
+    return false;
+}
+
+void ReadoutLoop::end()
+{
+    digi->stopAcquisition();
+    boardRunning = false;
+    //pull whatever was left on the board after the stop
+    while((digi->readReadoutStatus() & ReadoutStatusEventReadyBit) != 0)
+    {
+        this->readAndSubmit();
+    }
+    //the processing thread finishes the queue and flushes the chain
+    processor.stop();
+    running.store(false);
+    if(processor.getFailed())
+    {
+        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Processing Thread Failed For Digitizer #" << digi->getModuleNumber();
+        throw std::runtime_error("ReadoutLoop Error - Processing Thread Failed");
+    }
+}
+
+void ReadoutLoop::abort()
+{
+    //do not leave the board acquiring with nobody reading it out, the error
+    //that got us here is the one the caller passes up, the processing thread
+    //is abandoned rather than drained when the loop is destroyed
+    if(boardRunning)
+    {
+        try
+        {
+            digi->stopAcquisition();
+        }
+        catch(std::exception& stopErr)
+        {
+            BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Could Not Stop Acquisition On Digitizer #" << digi->getModuleNumber() << " After An Error: " << stopErr.what();
+        }
+        boardRunning = false;
+    }
+    running.store(false);
+}
+
+void ReadoutLoop::idleBackOff()
+{
+    //a short spin first so a board that is about to have data is read at
+    //once, past that the sleep doubles up to MaxIdleSleepUs so a quiet board
+    //does not keep the core and the link busy with status reads, the longest
+    //sleep is far shorter than the time it takes the board memory to fill
+    ++idleStreak;
+    if(idleStreak <= IdleSpinPolls)
+    {
+        return;
+    }
+    idleSleepUs = ((idleSleepUs == 0) ? 1 : (2 * idleSleepUs));
+    if(idleSleepUs > MaxIdleSleepUs)
+    {
+        idleSleepUs = MaxIdleSleepUs;
+    }
+    boost::this_thread::sleep_for(boost::chrono::microseconds(idleSleepUs));
+}
+
+void ReadoutLoop::readAndSubmit()
+{
+    int index = 0;
+    unsigned int* readBuffer = processor.acquireBuffer(index);
+    if(readBuffer == nullptr)
+    {
+        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Processing Thread Failed For Digitizer #" << digi->getModuleNumber();
+        throw std::runtime_error("ReadoutLoop Error - Processing Thread Failed");
+    }
+    int wordsRead = digi->readEvents(readBuffer, readBufferSize);
+    bytesRead += (4ULL * static_cast<unsigned long long>(wordsRead));
+    bufferFillMetric->set(static_cast<double>(wordsRead) / static_cast<double>(readBufferSize));
+    processor.submitBuffer(index, wordsRead);
+}
+
+void ReadoutLoop::recordUpdates(int count)
+{
+    unsigned long long wallTime = static_cast<unsigned long long>(boost::chrono::duration_cast<boost::chrono::nanoseconds>(boost::chrono::system_clock::now().time_since_epoch()).count());
+    for(int i=0; i<count; ++i)
+    {
+        //no log record here, they allocate, the command reader has already
+        //logged the request and the marker carries the address written, the
+        //processing thread stamps it with the board time once it has parsed
+        //every transfer queued ahead of it
+        processor.submitUpdate(appliedUpdates[i], wallTime);
+    }
+}
+
+}
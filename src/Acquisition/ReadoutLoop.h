@@ -0,0 +1,118 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ReadoutLoop.h
+** @author James Till Matta
+** @date 18 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the ReadoutLoop class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_ACQUISITION_READOUTLOOP_H
+#define ORCHID_SRC_ACQUISITION_READOUTLOOP_H
+// includes for C system headers
+// includes for C++ system headers
+#include<atomic>
+#include<string>
+// includes from other libraries
+// includes from ORCHID
+#include"Digitizer/Vx1730Digitizer.h"
+#include"Digitizer/LiveRegisterUpdate.h"
+#include"Filter/ChainConfig.h"
+#include"Metrics/Metric.h"
+#include"Utility/OrchidLogger.h"
+#include"ProcessingThread.h"
+
+namespace Acquisition
+{
+
+enum {MaxUpdatesPerPass = 64};
+
+//Runs a digitizer, pulling block transfers on the calling thread and handing
+//  them to a ProcessingThread that builds the event chain on its own core and
+//  pushes them through it, so the readout core only ever waits on the board
+//Between block transfers any queued live register changes are written to the
+//  board in one multi write and a marker pair for each is put in the output
+//  file, by way of the processing thread so the markers stay in order
+//A poll that finds nothing ready is followed by a bounded back off, a few
+//  back to back polls and then sleeps doubling up to 100 us, so an idle or
+//  slow board does not spin the readout core flat out on status reads
+//Every buffer is allocated and paged in before the board starts, so once the
+//  warm up time has passed neither thread should touch the heap at all, the
+//  allocations both make after warm up are counted in AllocTrack builds
+class ReadoutLoop
+{
+public:
+    //chainConfig and updateQueue may be nullptr
+    ReadoutLoop(Digitizer::Vx1730Digitizer* digitizer, const std::string& outFile,
+                const Filter::ChainConfig* chainConfig, Digitizer::LiveUpdateQueue* updateQueue);
+    ~ReadoutLoop();
+
+    //the digitizer must already be open and configured
+    void run(double seconds);
+    void stop(){running.store(false);}
+    //the pieces of run, for callers that drive the loop themselves, begin
+    //starts the processing thread and the board, poll makes one pass and
+    //returns true if it pulled a transfer, end stops the board, pulls what is
+    //left and finishes the processing thread (throwing if it failed), if
+    //anything between begin and end throws call abort before passing it on
+    void begin();
+    bool poll();
+    void end();
+    void abort();
+    void setWarmUpTime(double seconds){warmUpTime = seconds;}
+    //the cpu the parse, sort, filter and write thread pins itself to
+    void setProcessingCpu(int cpuNum){processor.setCpu(cpuNum);}
+
+    //the chain the processing thread built, nullptr before the first run
+    EventChain* getChain(){return processor.getChain();}
+    unsigned long long getBytesRead(){return bytesRead;}
+    unsigned long long getEventsParsed(){return processor.getEventsParsed();}
+    //only from the thread calling poll, transfers and register changes the
+    //processing thread has not taken yet, transfer buffers not waiting to be
+    //parsed, and times the readout had to wait for one
+    int getQueuedItems(){return processor.getQueuedItems();}
+    int getFreeBuffers(){return processor.getFreeBuffers();}
+    unsigned long long getBufferWaits(){return processor.getBufferWaits();}
+    bool getWarmedUp(){return warmedUp;}
+    unsigned long long getSteadyStateAllocations(){return steadyStateAllocs;}
+
+private:
+    void readAndSubmit();
+    void idleBackOff();
+    void recordUpdates(int count);
+
+    Digitizer::Vx1730Digitizer* digi;
+    Digitizer::LiveUpdateQueue* queue;
+    ProcessingThread processor;
+    int readBufferSize;
+    Digitizer::LiveRegisterUpdate appliedUpdates[MaxUpdatesPerPass];
+    std::atomic<bool> running;
+    bool boardRunning;
+    unsigned long long bytesRead;
+    //consecutive polls that found nothing and the current sleep between them
+    int idleStreak;
+    int idleSleepUs;
+    double warmUpTime;
+    bool warmedUp;
+    unsigned long long steadyStateAllocs;
+    //polls that found nothing ready, these are idle time not failed transfers
+    //so there is no retry count, readEvents throws if a transfer fails
+    Metrics::MetricCounter* idlePollsMetric;
+    Metrics::MetricCounter* liveUpdatesMetric;
+    Metrics::MetricGauge* bufferFillMetric;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_ACQUISITION_READOUTLOOP_H
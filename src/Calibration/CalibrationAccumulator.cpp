@@ -0,0 +1,42 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file CalibrationAccumulator.cpp
+** @author James Till Matta
+** @date 25 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the CalibrationAccumulator class
+**
+********************************************************************************
+*******************************************************************************/
+#include"CalibrationAccumulator.h"
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+
+namespace Calibration
+{
+
+void CalibrationAccumulator::reset()
+{
+    for(int i=0; i<MaxCalibrationChannels; ++i)
+    {
+        counts[i] = 0;
+        baselineSums[i] = 0;
+    }
+}
+
+double CalibrationAccumulator::getMeanBaseline(int channel)
+{
+    return (static_cast<double>(baselineSums[channel]) / static_cast<double>(counts[channel]));
+}
+
+}
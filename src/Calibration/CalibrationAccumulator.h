@@ -0,0 +1,62 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file CalibrationAccumulator.h
+** @author James Till Matta
+** @date 25 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the CalibrationAccumulator class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_CALIBRATION_CALIBRATIONACCUMULATOR_H
+#define ORCHID_SRC_CALIBRATION_CALIBRATIONACCUMULATOR_H
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+#include"Events/EventSink.h"
+
+namespace Calibration
+{
+
+enum {MaxCalibrationChannels = 256};
+
+//End of chain stage used while calibrating, keeps the event count and the sum
+//  of the event baselines for every global channel over one measurement step
+//The baseline sum only means something if the boards are set to put the
+//  baseline in the event extras word (extras option 0)
+class CalibrationAccumulator : public Events::EventSink
+{
+public:
+    CalibrationAccumulator(){this->reset();}
+    ~CalibrationAccumulator(){}
+
+    void acceptEvent(const Events::DppPsdEvent& event) override
+    {
+        ++counts[event.channel];
+        baselineSums[event.channel] += event.baseline;
+    }
+    void flush() override{}
+
+    void reset();
+
+    unsigned long long getCount(int channel){return counts[channel];}
+    //mean baseline in ADC counts, only valid if getCount is not zero
+    double getMeanBaseline(int channel);
+
+private:
+    unsigned long long counts[MaxCalibrationChannels];
+    unsigned long long baselineSums[MaxCalibrationChannels];
+};
+
+}
+
+#endif //ORCHID_SRC_CALIBRATION_CALIBRATIONACCUMULATOR_H
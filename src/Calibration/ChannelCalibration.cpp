@@ -0,0 +1,529 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ChannelCalibration.cpp
+** @author James Till Matta
+** @date 25 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the ChannelCalibration class
+**
+********************************************************************************
+*******************************************************************************/
+#include"ChannelCalibration.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<cmath>
+#include<fstream>
+#include<iomanip>
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+#include<boost/chrono.hpp>
+#include<boost/thread.hpp>
+// includes from ORCHID
+#include"Digitizer/Vx1730DigitizerRegisters.h"
+
+namespace Calibration
+{
+
+enum {ChannelsPerBoard = 16, ReadBufferInts = (256*1024), MaxBoards = (MaxCalibrationChannels / ChannelsPerBoard),
+      MaxOffsetSteps = 24, DacUnderStart = 0x0800, DacOverStart = 0xF800, MaxThreshold = 0x3FFF,
+      SettleTimeMs = 100, TriggerPassTimeMs = 1};
+
+static const unsigned int AcqRunBit = 0x00000004;
+static const double BaselineTolerance = 2.0;
+
+ChannelCalibration::ChannelCalibration(int numberOfLinks, int boardsPerLink, Utility::ThreadPlacement* placement) :
+    linkCount(numberOfLinks), boardsOnLink(boardsPerLink), boardCount(numberOfLinks * boardsPerLink),
+    targetBaseline(15000.0), targetRate(1.0), baselineStepTime(0.2), rateStepTime(1.0),
+    digitizers(), parsers(), links(), accumulator(), writeAddrs(), writeData(), readBuffers(),
+    acqCtrlBase(), requests(nullptr), states(), settings(), lg(OrchidLog::get())
+{
+    if((linkCount < 1) || (boardsOnLink < 1) || (boardCount > MaxBoards))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Calibration: Cannot Calibrate " << linkCount << " Link(s) Of " << boardsOnLink << " Board(s), Need At Least 1 Of Each And At Most " << MaxBoards << " Boards";
+        throw std::runtime_error("ChannelCalibration Error - Bad Board Count");
+    }
+    requests.reset(new Digitizer::AsyncRequest[static_cast<std::size_t>(boardCount)]);
+    for(int l=0; l<linkCount; ++l)
+    {
+        links.emplace_back(new Digitizer::AsyncLink(l));
+        links.back()->setWorkerCpu(placement->getReadoutCpu(l));
+    }
+    for(int b=0; b<boardCount; ++b)
+    {
+        //owned before it is opened so a failure part way through closes the
+        //boards that were already open
+        int module = Digitizer::Vx1730Digitizer::globalModuleNumber((b / boardsOnLink), boardsOnLink, this->slotOf(b));
+        digitizers.emplace_back(new Digitizer::Vx1730Digitizer(module, (b / boardsOnLink), this->slotOf(b)));
+        Digitizer::Vx1730Digitizer* digi = digitizers.back().get();
+        digi->openDigitizer();
+        this->linkOf(b).addBoard(digi->getHandle(), digi->getModuleNumber());
+        parsers.emplace_back(new Events::DppPsdParser(&accumulator, module, digi->getChannelStartInd()));
+        //room for the three calibrated registers of every channel
+        writeAddrs.push_back(std::vector<unsigned int>(3 * ChannelsPerBoard, 0));
+        writeData.push_back(std::vector<unsigned int>(3 * ChannelsPerBoard, 0));
+        readBuffers.emplace_back(new unsigned int[ReadBufferInts]);
+        acqCtrlBase.push_back(0);
+    }
+    states.resize(static_cast<std::size_t>(boardCount * ChannelsPerBoard));
+    settings.resize(states.size(), 0);
+}
+
+ChannelCalibration::~ChannelCalibration()
+{
+    //the link workers must be gone before the handles are closed
+    links.clear();
+    digitizers.clear();
+}
+
+void ChannelCalibration::runCalibration()
+{
+    using Digitizer::LowLvl::Vx1730ReadRegisters;
+    using Digitizer::LowLvl::Vx1730CommonReadRegistersAddr;
+    typedef boost::chrono::steady_clock Clock;
+    BOOST_LOG_SEV(lg, Information) << "Calibration: Calibrating " << numChannels() << " Channels On " << linkCount << " Link(s), Target Baseline " << targetBaseline << ", Target Noise Rate " << targetRate << " Hz";
+    Clock::time_point startTime = Clock::now();
+    //grab the acquisition control of each board so we can set and clear the run bit
+    for(int i=0; i<boardCount; ++i)
+    {
+        this->linkOf(i).read32(this->slotOf(i), Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::AcquisitionCtrl>::value, requests[i]);
+    }
+    Digitizer::AsyncLink::waitAll(requests.get(), boardCount);
+    for(int i=0; i<boardCount; ++i)
+    {
+        acqCtrlBase[static_cast<std::size_t>(i)] = (requests[i].getValue() & (~AcqRunBit));
+    }
+
+    this->calibrateOffsets();
+    this->calibrateThresholds();
+    this->writeFinalValues();
+
+    double elapsed = boost::chrono::duration<double>(Clock::now() - startTime).count();
+    BOOST_LOG_SEV(lg, Information) << "Calibration: Results For " << linkCount << " Link(s)";
+    BOOST_LOG_SEV(lg, Information) << "Calibration:  Board | Chan | DcOffset | Baseline | TrgThreshold | Rate (Hz)";
+    int offsetMisses = 0;
+    int thresholdMisses = 0;
+    for(int i=0; i<numChannels(); ++i)
+    {
+        const ChannelCalState& state = states[static_cast<std::size_t>(i)];
+        if(!state.valid)
+        {
+            BOOST_LOG_SEV(lg, Warning) << "Calibration: " << std::setw(6) << (i / ChannelsPerBoard) << " | " << std::setw(4) << (i % ChannelsPerBoard) << " | No Events, Not Calibrated";
+            continue;
+        }
+        std::ostringstream threshold;
+        std::ostringstream rate;
+        if(state.thresholdConverged)
+        {
+            threshold << state.hiThr;
+            rate << state.rate;
+        }
+        else
+        {
+            threshold << "Not Converged";
+            rate << "> " << targetRate;
+            ++thresholdMisses;
+        }
+        offsetMisses += (state.offsetConverged ? 0 : 1);
+        BOOST_LOG_SEV(lg, Information) << "Calibration: " << std::setw(6) << (i / ChannelsPerBoard) << " | "
+                                       << std::setw(4) << (i % ChannelsPerBoard) << " | 0x"
+                                       << std::hex << std::setw(4) << std::setfill('0') << state.dcOffset << std::dec << std::setfill(' ')
+                                       << (state.offsetConverged ? "   | " : " * | ")
+                                       << std::setw(8) << state.baseline << " | "
+                                       << std::setw(13) << threshold.str() << " | "
+                                       << rate.str();
+    }
+    if(offsetMisses > 0)
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Calibration: " << offsetMisses << " Channel(s) Marked * Did Not Reach The Target Baseline, Their Closest DcOffset Was Kept";
+    }
+    if(thresholdMisses > 0)
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Calibration: " << thresholdMisses << " Channel(s) Never Got Down To " << targetRate << " Hz, Their TrgThreshold Is Left At Maximum And Not Put In The Image";
+    }
+    BOOST_LOG_SEV(lg, Information) << "Calibration: Finished In " << elapsed << " s";
+}
+
+void ChannelCalibration::writeRegisterImage(const std::string& fileName)
+{
+    using Digitizer::LowLvl::Vx1730WriteRegisters;
+    using Digitizer::LowLvl::Vx1730IndivWriteRegistersAddr;
+    using Digitizer::LowLvl::Vx1730IndivWriteRegistersOffs;
+    std::ofstream image(fileName.c_str());
+    if(!image.good())
+    {
+        BOOST_LOG_SEV(lg, Error) << "Calibration: Could Not Open Register Image File: " << fileName;
+        throw std::runtime_error("ChannelCalibration Error - Could Not Open Register Image");
+    }
+    image << "# ORCHID calibration register image, " << linkCount << " link(s) of " << boardsOnLink << " board(s)\n";
+    image << "# link board channel register address value\n";
+    for(int i=0; i<numChannels(); ++i)
+    {
+        const ChannelCalState& state = states[static_cast<std::size_t>(i)];
+        if(!state.valid)
+        {
+            continue;
+        }
+        int board = (i / ChannelsPerBoard);
+        int chan = (i % ChannelsPerBoard);
+        unsigned int offs = (Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::DcOffset>::value * static_cast<unsigned int>(chan));
+        std::ostringstream prefix;
+        prefix << (board / boardsOnLink) << " " << this->slotOf(board) << " " << chan;
+        image << prefix.str() << " DcOffset 0x" << std::hex << std::setw(4) << std::setfill('0')
+              << (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DcOffset>::value + offs) << " 0x" << std::setw(8) << state.dcOffset << std::dec << "\n";
+        image << prefix.str() << " FixedBaseline 0x" << std::hex << std::setw(4) << std::setfill('0')
+              << (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::FixedBaseline>::value + offs) << " 0x" << std::setw(8)
+              << static_cast<unsigned int>(std::lround(state.baseline)) << std::dec << "\n";
+        if(!state.thresholdConverged)
+        {
+            image << "# " << prefix.str() << " TrgThreshold not converged\n";
+            continue;
+        }
+        image << prefix.str() << " TrgThreshold 0x" << std::hex << std::setw(4) << std::setfill('0')
+              << (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value + offs) << " 0x" << std::setw(8) << state.hiThr << std::dec << "\n";
+    }
+    BOOST_LOG_SEV(lg, Information) << "Calibration: Wrote Register Image To: " << fileName;
+}
+
+void ChannelCalibration::calibrateOffsets()
+{
+    using Digitizer::LowLvl::Vx1730WriteRegisters;
+    using Digitizer::LowLvl::Vx1730IndivWriteRegistersAddr;
+    //keep the channels from self triggering so only the software triggers land
+    std::vector<unsigned int> maxThresh(states.size(), MaxThreshold);
+    this->writeChannelValues(Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value, maxThresh);
+
+    //measure both ends of the DAC range, every channel must have the target
+    //between them for the search to start
+    unsigned int ends[2] = {DacUnderStart, DacOverStart};
+    double endBaselines[2][MaxCalibrationChannels];
+    for(int e=0; e<2; ++e)
+    {
+        for(std::size_t i=0; i<settings.size(); ++i)
+        {
+            settings[i] = ends[e];
+        }
+        this->writeChannelValues(Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DcOffset>::value, settings);
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(SettleTimeMs));
+        this->measure(baselineStepTime, true);
+        for(int i=0; i<numChannels(); ++i)
+        {
+            endBaselines[e][i] = ((accumulator.getCount(i) != 0) ? accumulator.getMeanBaseline(i) : -1.0);
+        }
+    }
+    for(int i=0; i<numChannels(); ++i)
+    {
+        ChannelCalState& state = states[static_cast<std::size_t>(i)];
+        state.valid = ((endBaselines[0][i] >= 0.0) && (endBaselines[1][i] >= 0.0));
+        state.offsetDone = !state.valid;
+        state.offsetConverged = false;
+        state.lastSide = 0;
+        state.dcOffset = ends[0];
+        state.baseline = endBaselines[0][i];
+        if(!state.valid)
+        {
+            continue;
+        }
+        //the DAC can move the baseline either way depending on the input
+        //polarity, so sort the ends by which side of the target they fall
+        int underEnd = ((endBaselines[0][i] <= endBaselines[1][i]) ? 0 : 1);
+        state.underDac = ends[underEnd];
+        state.underBaseline = endBaselines[underEnd][i];
+        state.overDac = ends[1 - underEnd];
+        state.overBaseline = endBaselines[1 - underEnd][i];
+        if((state.underBaseline > targetBaseline) || (state.overBaseline < targetBaseline))
+        {
+            BOOST_LOG_SEV(lg, Warning) << "Calibration: Target Baseline Out Of Reach For Board " << (i / ChannelsPerBoard) << " Channel " << (i % ChannelsPerBoard) << ", Using Closest End";
+            bool underCloser = (std::fabs(state.underBaseline - targetBaseline) <= std::fabs(state.overBaseline - targetBaseline));
+            state.dcOffset = (underCloser ? state.underDac : state.overDac);
+            state.baseline = (underCloser ? state.underBaseline : state.overBaseline);
+            state.offsetDone = true;
+        }
+    }
+
+    for(int step=0; step<MaxOffsetSteps; ++step)
+    {
+        int remaining = 0;
+        for(std::size_t i=0; i<states.size(); ++i)
+        {
+            settings[i] = (states[i].offsetDone ? states[i].dcOffset : this->nextOffsetSetting(states[i]));
+            remaining += (states[i].offsetDone ? 0 : 1);
+        }
+        BOOST_LOG_SEV(lg, Information) << "Calibration: DcOffset Step " << step << ", " << remaining << " Channels Still Searching";
+        if(remaining == 0)
+        {
+            break;
+        }
+        this->writeChannelValues(Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DcOffset>::value, settings);
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(SettleTimeMs));
+        this->measure(baselineStepTime, true);
+        for(int i=0; i<numChannels(); ++i)
+        {
+            ChannelCalState& state = states[static_cast<std::size_t>(i)];
+            if(state.offsetDone || (accumulator.getCount(i) == 0))
+            {
+                continue;
+            }
+            state.dcOffset = settings[static_cast<std::size_t>(i)];
+            this->updateOffsetBracket(state, accumulator.getMeanBaseline(i));
+        }
+    }
+    //leave every channel on its best setting for the threshold search
+    for(std::size_t i=0; i<states.size(); ++i)
+    {
+        settings[i] = states[i].dcOffset;
+    }
+    this->writeChannelValues(Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DcOffset>::value, settings);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(SettleTimeMs));
+}
+
+unsigned int ChannelCalibration::nextOffsetSetting(ChannelCalState& state)
+{
+    unsigned int lower = ((state.underDac < state.overDac) ? state.underDac : state.overDac);
+    unsigned int upper = ((state.underDac < state.overDac) ? state.overDac : state.underDac);
+    unsigned int midpoint = (lower + ((upper - lower) / 2));
+    //after the same end moved twice the secant is converging from one side
+    //only, take a bisection step to pull the other end in
+    if((state.lastSide == 2) || (state.lastSide == -2))
+    {
+        return midpoint;
+    }
+    double span = (state.overBaseline - state.underBaseline);
+    if(span <= 0.0)
+    {
+        return midpoint;
+    }
+    double frac = ((targetBaseline - state.underBaseline) / span);
+    double guess = (static_cast<double>(state.underDac) + frac * (static_cast<double>(state.overDac) - static_cast<double>(state.underDac)));
+    unsigned int setting = static_cast<unsigned int>(std::lround(guess));
+    if((setting <= lower) || (setting >= upper))
+    {
+        return midpoint;
+    }
+    return setting;
+}
+
+void ChannelCalibration::updateOffsetBracket(ChannelCalState& state, double baseline)
+{
+    state.baseline = baseline;
+    if(std::fabs(baseline - targetBaseline) <= BaselineTolerance)
+    {
+        state.offsetDone = true;
+        state.offsetConverged = true;
+        return;
+    }
+    if(baseline < targetBaseline)
+    {
+        state.underDac = state.dcOffset;
+        state.underBaseline = baseline;
+        state.lastSide = ((state.lastSide < 0) ? (state.lastSide - 1) : -1);
+    }
+    else
+    {
+        state.overDac = state.dcOffset;
+        state.overBaseline = baseline;
+        state.lastSide = ((state.lastSide > 0) ? (state.lastSide + 1) : 1);
+    }
+    if((state.lastSide < -2) || (state.lastSide > 2))
+    {
+        state.lastSide = 0;
+    }
+    //the bracket is down to adjacent DAC codes, take the closer of the two
+    unsigned int width = ((state.underDac < state.overDac) ? (state.overDac - state.underDac) : (state.underDac - state.overDac));
+    if(width <= 1)
+    {
+        bool underCloser = ((targetBaseline - state.underBaseline) <= (state.overBaseline - targetBaseline));
+        state.dcOffset = (underCloser ? state.underDac : state.overDac);
+        state.baseline = (underCloser ? state.underBaseline : state.overBaseline);
+        state.offsetDone = true;
+        state.offsetConverged = true;
+    }
+}
+
+void ChannelCalibration::calibrateThresholds()
+{
+    using Digitizer::LowLvl::Vx1730WriteRegisters;
+    using Digitizer::LowLvl::Vx1730IndivWriteRegistersAddr;
+    for(std::size_t i=0; i<states.size(); ++i)
+    {
+        states[i].loThr = 1;
+        states[i].hiThr = MaxThreshold;
+        states[i].rate = 0.0;
+        states[i].thresholdDone = !states[i].valid;
+        states[i].thresholdConverged = false;
+    }
+    while(true)
+    {
+        int remaining = 0;
+        for(std::size_t i=0; i<states.size(); ++i)
+        {
+            if(!states[i].thresholdDone && (states[i].loThr >= states[i].hiThr))
+            {
+                states[i].thresholdDone = true;
+            }
+            settings[i] = (states[i].thresholdDone ? states[i].hiThr : (states[i].loThr + ((states[i].hiThr - states[i].loThr) / 2)));
+            remaining += (states[i].thresholdDone ? 0 : 1);
+        }
+        BOOST_LOG_SEV(lg, Information) << "Calibration: TrgThreshold Step, " << remaining << " Channels Still Searching";
+        if(remaining == 0)
+        {
+            break;
+        }
+        this->writeChannelValues(Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value, settings);
+        double runTime = this->measure(rateStepTime, false);
+        for(int i=0; i<numChannels(); ++i)
+        {
+            ChannelCalState& state = states[static_cast<std::size_t>(i)];
+            if(state.thresholdDone)
+            {
+                continue;
+            }
+            double rate = (static_cast<double>(accumulator.getCount(i)) / runTime);
+            if(rate <= targetRate)
+            {
+                state.hiThr = settings[static_cast<std::size_t>(i)];
+                state.rate = rate;
+                state.thresholdConverged = true;
+            }
+            else
+            {
+                state.loThr = (settings[static_cast<std::size_t>(i)] + 1);
+            }
+        }
+    }
+}
+
+void ChannelCalibration::writeFinalValues()
+{
+    using Digitizer::LowLvl::Vx1730WriteRegisters;
+    using Digitizer::LowLvl::Vx1730IndivWriteRegistersAddr;
+    using Digitizer::LowLvl::Vx1730IndivWriteRegistersOffs;
+    //all three registers for every channel of a board go in one multi write
+    for(int b=0; b<boardCount; ++b)
+    {
+        std::vector<unsigned int>& addrs = writeAddrs[static_cast<std::size_t>(b)];
+        std::vector<unsigned int>& data = writeData[static_cast<std::size_t>(b)];
+        int count = 0;
+        for(int c=0; c<ChannelsPerBoard; ++c)
+        {
+            const ChannelCalState& state = states[static_cast<std::size_t>((b * ChannelsPerBoard) + c)];
+            if(!state.valid)
+            {
+                continue;
+            }
+            unsigned int offs = (Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::DcOffset>::value * static_cast<unsigned int>(c));
+            addrs[static_cast<std::size_t>(count)] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DcOffset>::value + offs);
+            data[static_cast<std::size_t>(count++)] = state.dcOffset;
+            addrs[static_cast<std::size_t>(count)] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::FixedBaseline>::value + offs);
+            data[static_cast<std::size_t>(count++)] = static_cast<unsigned int>(std::lround(state.baseline));
+            addrs[static_cast<std::size_t>(count)] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value + offs);
+            data[static_cast<std::size_t>(count++)] = state.hiThr;
+        }
+        if(count != 0)
+        {
+            this->linkOf(b).multiWrite32(this->slotOf(b), addrs.data(), data.data(), count, requests[b]);
+        }
+    }
+    Digitizer::AsyncLink::waitAll(requests.get(), boardCount);
+}
+
+void ChannelCalibration::writeChannelValues(unsigned short regAddr, const std::vector<unsigned int>& values)
+{
+    using Digitizer::LowLvl::Vx1730WriteRegisters;
+    using Digitizer::LowLvl::Vx1730IndivWriteRegistersOffs;
+    for(int b=0; b<boardCount; ++b)
+    {
+        std::vector<unsigned int>& addrs = writeAddrs[static_cast<std::size_t>(b)];
+        std::vector<unsigned int>& data = writeData[static_cast<std::size_t>(b)];
+        for(int c=0; c<ChannelsPerBoard; ++c)
+        {
+            addrs[static_cast<std::size_t>(c)] = (regAddr + (Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::DcOffset>::value * static_cast<unsigned int>(c)));
+            data[static_cast<std::size_t>(c)] = values[static_cast<std::size_t>((b * ChannelsPerBoard) + c)];
+        }
+        this->linkOf(b).multiWrite32(this->slotOf(b), addrs.data(), data.data(), ChannelsPerBoard, requests[b]);
+    }
+    Digitizer::AsyncLink::waitAll(requests.get(), boardCount);
+}
+
+double ChannelCalibration::measure(double seconds, bool softwareTriggers)
+{
+    using Digitizer::LowLvl::Vx1730WriteRegisters;
+    using Digitizer::LowLvl::Vx1730CommonWriteRegistersAddr;
+    typedef boost::chrono::steady_clock Clock;
+    accumulator.reset();
+    this->setRunning(true);
+    Clock::time_point startTime = Clock::now();
+    Clock::time_point stopTime = (startTime + boost::chrono::duration_cast<Clock::duration>(boost::chrono::duration<double>(seconds)));
+    while(Clock::now() < stopTime)
+    {
+        if(softwareTriggers)
+        {
+            for(int b=0; b<boardCount; ++b)
+            {
+                this->linkOf(b).write32(this->slotOf(b), Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::SoftwareTrg>::value, 0x00000001, requests[b]);
+            }
+            Digitizer::AsyncLink::waitAll(requests.get(), boardCount);
+        }
+        this->readAndParseAll();
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(TriggerPassTimeMs));
+    }
+    this->setRunning(false);
+    double runTime = boost::chrono::duration<double>(Clock::now() - startTime).count();
+    //pull whatever was left on the boards when they stopped, an empty read
+    //from every board means they are all drained
+    while(true)
+    {
+        unsigned long long before = 0;
+        for(int i=0; i<numChannels(); ++i)
+        {
+            before += accumulator.getCount(i);
+        }
+        this->readAndParseAll();
+        unsigned long long after = 0;
+        for(int i=0; i<numChannels(); ++i)
+        {
+            after += accumulator.getCount(i);
+        }
+        if(after == before)
+        {
+            break;
+        }
+    }
+    return runTime;
+}
+
+void ChannelCalibration::setRunning(bool run)
+{
+    using Digitizer::LowLvl::Vx1730WriteRegisters;
+    using Digitizer::LowLvl::Vx1730CommonWriteRegistersAddr;
+    for(int b=0; b<boardCount; ++b)
+    {
+        unsigned int value = (acqCtrlBase[static_cast<std::size_t>(b)] | (run ? AcqRunBit : 0));
+        this->linkOf(b).write32(this->slotOf(b), Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AcquisitionCtrl>::value, value, requests[b]);
+    }
+    Digitizer::AsyncLink::waitAll(requests.get(), boardCount);
+}
+
+void ChannelCalibration::readAndParseAll()
+{
+    //every board transfers at once, then the buffers are parsed in turn
+    for(int b=0; b<boardCount; ++b)
+    {
+        this->linkOf(b).blockRead(this->slotOf(b), readBuffers[static_cast<std::size_t>(b)].get(), ReadBufferInts, requests[b]);
+    }
+    Digitizer::AsyncLink::waitAll(requests.get(), boardCount);
+    for(int b=0; b<boardCount; ++b)
+    {
+        parsers[static_cast<std::size_t>(b)]->parseBuffer(readBuffers[static_cast<std::size_t>(b)].get(), requests[b].getWordsRead());
+    }
+}
+
+}
@@ -0,0 +1,144 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ChannelCalibration.h
+** @author James Till Matta
+** @date 25 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the ChannelCalibration class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_CALIBRATION_CHANNELCALIBRATION_H
+#define ORCHID_SRC_CALIBRATION_CHANNELCALIBRATION_H
+// includes for C system headers
+// includes for C++ system headers
+#include<memory>
+#include<string>
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Digitizer/Vx1730Digitizer.h"
+#include"Digitizer/AsyncLink.h"
+#include"Events/DppPsdParser.h"
+#include"CalibrationAccumulator.h"
+#include"Utility/ThreadPlacement.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Calibration
+{
+
+//search state and results for one channel
+struct ChannelCalState
+{
+    //DcOffset search, the bracket is held as the DAC settings whose baselines
+    //fell below (Under) and above (Over) the target
+    unsigned int underDac;
+    unsigned int overDac;
+    double underBaseline;
+    double overBaseline;
+    int lastSide;           //-1 if the last step replaced under, 1 if over
+    unsigned int dcOffset;
+    double baseline;
+    bool offsetDone;
+    bool offsetConverged;   //false if the target was out of reach or steps ran out
+    //TrgThreshold search, rate(hiThr) is at or below the target once a
+    //setting has been measured there
+    unsigned int loThr;
+    unsigned int hiThr;
+    double rate;
+    bool thresholdDone;
+    bool thresholdConverged;//false if no setting got the rate down to the target
+    bool valid;             //false if the channel gave no events to measure
+};
+
+//Calibrates DcOffset, FixedBaseline and TrgThreshold for every channel of
+//  every board on every optical link at the same time, each link gets its own
+//  AsyncLink so all links and all boards on them are in flight together
+//Boards are numbered globally, link by link, and the board number is also
+//  the module number so global channel = (board * 16) + channel
+//Each step writes one value per channel to all boards with a multi write per
+//  board, runs every board at once while pulling and parsing their data in
+//  parallel through the AsyncLinks, then moves every channel that is not done
+//  to its next setting
+//DcOffset: secant steps inside a bracket that always holds the target
+//  baseline, falling back to bisection when the same side of the bracket
+//  moves twice in a row, the baseline comes from software triggered events
+//FixedBaseline: the converged baseline position
+//TrgThreshold: bisection for the lowest threshold whose self triggered rate
+//  is at or below the target rate, a channel that never gets there is marked
+//  not converged and left out of the register image
+//The register image has one line per register:
+//    <link> <board on link> <channel> <register name> <address> <value>
+//The boards must already be configured with extras option 0 so the event
+//  baseline is present, FixedBaseline is only written, switching the baseline
+//  mode to fixed is left to the configuration
+class ChannelCalibration
+{
+public:
+    ChannelCalibration(int numberOfLinks, int boardsPerLink, Utility::ThreadPlacement* placement);
+    ~ChannelCalibration();
+
+    void setTargets(double baselineTarget, double triggerRateTarget){targetBaseline = baselineTarget; targetRate = triggerRateTarget;}
+    void setStepDurations(double baselineSeconds, double rateSeconds){baselineStepTime = baselineSeconds; rateStepTime = rateSeconds;}
+
+    void runCalibration();
+    void writeRegisterImage(const std::string& fileName);
+
+private:
+    void calibrateOffsets();
+    void calibrateThresholds();
+    void updateOffsetBracket(ChannelCalState& state, double baseline);
+    unsigned int nextOffsetSetting(ChannelCalState& state);
+
+    void writeChannelValues(unsigned short regAddr, const std::vector<unsigned int>& values);
+    void writeFinalValues();
+    //runs all boards for a step, returns how long they were running
+    double measure(double seconds, bool softwareTriggers);
+    void setRunning(bool run);
+    void readAndParseAll();
+    int numChannels(){return static_cast<int>(states.size());}
+    //the link a (global) board hangs off of and its index on that link
+    Digitizer::AsyncLink& linkOf(int board){return *(links[static_cast<std::size_t>(board / boardsOnLink)]);}
+    int slotOf(int board){return (board % boardsOnLink);}
+
+    int linkCount;
+    int boardsOnLink;
+    int boardCount;
+    double targetBaseline;
+    double targetRate;
+    double baselineStepTime;
+    double rateStepTime;
+
+    //the links are declared after the digitizers so that they, and their
+    //workers, are gone before the digitizers close their handles
+    std::vector<std::unique_ptr<Digitizer::Vx1730Digitizer> > digitizers;
+    std::vector<std::unique_ptr<Events::DppPsdParser> > parsers;
+    std::vector<std::unique_ptr<Digitizer::AsyncLink> > links;
+    CalibrationAccumulator accumulator;
+
+    //per board arrays, they must stay put while requests are in flight
+    std::vector<std::vector<unsigned int> > writeAddrs;
+    std::vector<std::vector<unsigned int> > writeData;
+    std::vector<std::unique_ptr<unsigned int[]> > readBuffers;
+    std::vector<unsigned int> acqCtrlBase;
+    //one completion record per board, every call waits on all of them
+    std::unique_ptr<Digitizer::AsyncRequest[]> requests;
+
+    //indexed by global channel, (board * 16) + channel
+    std::vector<ChannelCalState> states;
+    std::vector<unsigned int> settings;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_CALIBRATION_CHANNELCALIBRATION_H
@@ -0,0 +1,196 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file CommandFifoReader.cpp
+** @author James Till Matta
+** @date 18 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the CommandFifoReader class
+**
+********************************************************************************
+*******************************************************************************/
+#include"CommandFifoReader.h"
+// includes for C system headers
+#include<sys/types.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<poll.h>
+#include<unistd.h>
+#include<errno.h>
+// includes for C++ system headers
+#include<cstdlib>
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+#include"Utility/ThreadPlacement.h"
+
+namespace Control
+{
+
+enum {PollTimeoutMs = 200, ReadChunkSize = 512};
+
+CommandFifoReader::CommandFifoReader(const std::string& fifoPath, Digitizer::LiveUpdateQueue* updateQueue) :
+    path(fifoPath), queue(updateQueue), running(false), cpu(-1), listenThread(nullptr),
+    lg(OrchidLog::get())
+{
+}
+
+CommandFifoReader::~CommandFifoReader()
+{
+    this->stop();
+}
+
+void CommandFifoReader::start()
+{
+    if((mkfifo(path.c_str(), 0660) != 0) && (errno != EEXIST))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Control: Could Not Create Command FIFO: " << path;
+        throw std::runtime_error("CommandFifoReader Error - Could Not Create FIFO");
+    }
+    running.store(true);
+    listenThread = new boost::thread(&CommandFifoReader::readLoop, this);
+    BOOST_LOG_SEV(lg, Information) << "Control: Listening For Live Register Changes On: " << path;
+}
+
+void CommandFifoReader::stop()
+{
+    if(listenThread != nullptr)
+    {
+        running.store(false);
+        listenThread->join();
+        delete listenThread;
+        listenThread = nullptr;
+    }
+}
+
+void CommandFifoReader::readLoop()
+{
+    Utility::ThreadPlacement::pinCallingThread(cpu);
+    //opening read/write means we always count as a writer ourselves, so the
+    //pipe never signals hang up between external writers
+    int fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+    if(fd < 0)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Control: Could Not Open Command FIFO: " << path;
+        return;
+    }
+    std::string pending;
+    char chunk[ReadChunkSize];
+    while(running.load())
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if(poll(&pfd, 1, PollTimeoutMs) <= 0)
+        {
+            continue;
+        }
+        ssize_t bytesRead = read(fd, chunk, ReadChunkSize);
+        if(bytesRead <= 0)
+        {
+            continue;
+        }
+        pending.append(chunk, static_cast<std::size_t>(bytesRead));
+        std::size_t lineEnd = 0;
+        while((lineEnd = pending.find('\n')) != std::string::npos)
+        {
+            this->handleLine(pending.substr(0, lineEnd));
+            pending.erase(0, lineEnd + 1);
+        }
+    }
+    close(fd);
+}
+
+void CommandFifoReader::handleLine(const std::string& line)
+{
+    std::istringstream lineStream(line);
+    std::string chanStr;
+    std::string regStr;
+    //read signed so that a negative value is caught rather than wrapped
+    long long value = 0;
+    if(!(lineStream >> chanStr >> regStr >> value))
+    {
+        if(!line.empty())
+        {
+            BOOST_LOG_SEV(lg, Warning) << "Control: Malformed Command: \"" << line << "\"";
+        }
+        return;
+    }
+    Digitizer::LiveRegisterUpdate update;
+    update.value = 0;
+    update.address = 0;
+    if(chanStr == "all")
+    {
+        update.channel = Digitizer::LiveUpdateAllChannels;
+    }
+    else
+    {
+        //the whole token has to be the number, so "foo" or "3x" is not channel 0 or 3
+        char* chanEnd = nullptr;
+        long chan = std::strtol(chanStr.c_str(), &chanEnd, 10);
+        if((chanEnd == chanStr.c_str()) || (*chanEnd != '\0') ||
+           (chan < 0) || (chan >= Digitizer::LiveUpdateBoardChannels))
+        {
+            BOOST_LOG_SEV(lg, Warning) << "Control: Bad Channel In Command: \"" << line << "\"";
+            return;
+        }
+        update.channel = static_cast<unsigned char>(chan);
+    }
+    if(regStr == "TrgThreshold")
+    {
+        update.reg = Digitizer::LiveRegister::TrgThreshold;
+    }
+    else if(regStr == "ShortGate")
+    {
+        update.reg = Digitizer::LiveRegister::ShortGate;
+    }
+    else if(regStr == "LongGate")
+    {
+        update.reg = Digitizer::LiveRegister::LongGate;
+    }
+    else if(regStr == "GateOffset")
+    {
+        update.reg = Digitizer::LiveRegister::GateOffset;
+    }
+    else if(regStr == "PsdCutThreshold")
+    {
+        update.reg = Digitizer::LiveRegister::PsdCutThreshold;
+    }
+    else if(regStr == "TrgHoldOff")
+    {
+        update.reg = Digitizer::LiveRegister::TrgHoldOff;
+    }
+    else if(regStr == "ShapedTrgWidth")
+    {
+        update.reg = Digitizer::LiveRegister::ShapedTrgWidth;
+    }
+    else
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Control: Register " << regStr << " Cannot Be Changed While Running";
+        return;
+    }
+    unsigned int maxValue = Digitizer::liveRegisterMaxValue(update.reg);
+    if((value < 0) || (value > static_cast<long long>(maxValue)))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Control: Value " << value << " Out Of Range For " << regStr << " (0 To " << maxValue << "), Rejected: \"" << line << "\"";
+        return;
+    }
+    update.value = static_cast<unsigned int>(value);
+    if(!queue->push(update))
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Control: Live Update Queue Full, Dropped: \"" << line << "\"";
+        return;
+    }
+    BOOST_LOG_SEV(lg, Information) << "Control: Queued Live Update: \"" << line << "\"";
+}
+
+}
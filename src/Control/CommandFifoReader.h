@@ -0,0 +1,68 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file CommandFifoReader.h
+** @author James Till Matta
+** @date 18 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the CommandFifoReader class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_CONTROL_COMMANDFIFOREADER_H
+#define ORCHID_SRC_CONTROL_COMMANDFIFOREADER_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<atomic>
+// includes from other libraries
+#include<boost/thread.hpp>
+// includes from ORCHID
+#include"Digitizer/LiveRegisterUpdate.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Control
+{
+
+//Listens on a named pipe for register changes to make while running and
+//  queues them for the readout loop, one command per line:
+//      <channel|all> <register> <value>
+//  where channel is 0 to 15, register is one of TrgThreshold, ShortGate,
+//  LongGate, GateOffset, PsdCutThreshold, TrgHoldOff, ShapedTrgWidth, and
+//  value must fit the register's field, a command that does not is logged and rejected
+//If the queue is full the command is dropped (and logged) rather than making
+//  anyone wait
+class CommandFifoReader
+{
+public:
+    CommandFifoReader(const std::string& fifoPath, Digitizer::LiveUpdateQueue* updateQueue);
+    ~CommandFifoReader();
+
+    //the cpu the listening thread pins itself to, -1 (the default) for any
+    void setCpu(int cpuNum){cpu = cpuNum;}
+    void start();
+    void stop();
+
+private:
+    void readLoop();
+    void handleLine(const std::string& line);
+
+    std::string path;
+    Digitizer::LiveUpdateQueue* queue;
+    std::atomic<bool> running;
+    int cpu;
+    boost::thread* listenThread;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_CONTROL_COMMANDFIFOREADER_H
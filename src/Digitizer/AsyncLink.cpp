@@ -0,0 +1,332 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file AsyncLink.cpp
+** @author James Till Matta
+** @date 22 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the AsyncLink class
+**
+********************************************************************************
+*******************************************************************************/
+#include"AsyncLink.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+#include<boost/thread.hpp>
+// includes from ORCHID
+#include"Vx1730DigitizerRegisters.h"
+#include"Metrics/MetricsRegistry.h"
+#include"Utility/ThreadPlacement.h"
+
+namespace Digitizer
+{
+
+enum {Read32Request, Write32Request, MultiRead32Request, MultiWrite32Request, BlockReadRequest};
+
+//one slot of a board's ring, the call to make and where its result goes
+struct LinkRequest
+{
+    int type;
+    unsigned int addr;
+    unsigned int value;     //the value to write, or the size of a block read
+    unsigned int* addrs;
+    unsigned int* data;     //multi cycle data, or the block read buffer
+    int count;
+    AsyncRequest* record;
+};
+
+//everything but the cycle error array is guarded by queueMutex, queueCond
+//wakes the worker when a request is added and doneCond wakes submitters
+//waiting for a free slot and waiters waiting for a request to finish
+struct AsyncBoardWorker
+{
+    int handle;
+    int moduleNumber;
+    int cpu;
+    bool stopping;
+    LinkRequest ring[AsyncRingSize];
+    unsigned long long submitted;
+    unsigned long long taken;
+    boost::mutex queueMutex;
+    boost::condition_variable queueCond;
+    boost::condition_variable doneCond;
+    boost::thread* thread;
+    CAENComm_ErrorCode cycleErrs[MultiRWArraySize];
+};
+
+AsyncLink::AsyncLink(int linkNum) : linkNumber(linkNum), workerCpu(-1), boards(), lg(OrchidLog::get())
+{
+}
+
+AsyncLink::~AsyncLink()
+{
+    //let each worker finish what it was given and then shut it down
+    for(std::size_t i=0; i<boards.size(); ++i)
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(boards[i]->queueMutex);
+            boards[i]->stopping = true;
+        }
+        boards[i]->queueCond.notify_one();
+        boards[i]->thread->join();
+        delete boards[i]->thread;
+        delete boards[i];
+    }
+}
+
+int AsyncLink::addBoard(int handle, int moduleNumber)
+{
+    AsyncBoardWorker* worker = new AsyncBoardWorker();
+    worker->handle = handle;
+    worker->moduleNumber = moduleNumber;
+    worker->cpu = workerCpu;
+    worker->stopping = false;
+    worker->submitted = 0;
+    worker->taken = 0;
+    worker->thread = new boost::thread(&AsyncLink::workerLoop, this, worker);
+    boards.push_back(worker);
+    BOOST_LOG_SEV(lg, Information) << "Async Link " << linkNumber << ": Added Digitizer #" << moduleNumber << " As Board " << (boards.size() - 1);
+    return static_cast<int>(boards.size() - 1);
+}
+
+void AsyncLink::read32(int board, unsigned int addr, AsyncRequest& request)
+{
+    this->submit(this->getWorker(board), Read32Request, addr, 0, nullptr, nullptr, 0, request);
+}
+
+void AsyncLink::write32(int board, unsigned int addr, unsigned int value, AsyncRequest& request)
+{
+    this->submit(this->getWorker(board), Write32Request, addr, value, nullptr, nullptr, 0, request);
+}
+
+void AsyncLink::multiRead32(int board, unsigned int* addrs, unsigned int* data, int count, AsyncRequest& request)
+{
+    AsyncBoardWorker* worker = this->getWorker(board);
+    checkCycleCount(count, worker->moduleNumber);
+    this->submit(worker, MultiRead32Request, 0, 0, addrs, data, count, request);
+}
+
+void AsyncLink::multiWrite32(int board, unsigned int* addrs, unsigned int* data, int count, AsyncRequest& request)
+{
+    AsyncBoardWorker* worker = this->getWorker(board);
+    checkCycleCount(count, worker->moduleNumber);
+    this->submit(worker, MultiWrite32Request, 0, 0, addrs, data, count, request);
+}
+
+void AsyncLink::blockRead(int board, unsigned int* buffer, int bufferSizeInts, AsyncRequest& request)
+{
+    this->submit(this->getWorker(board), BlockReadRequest, 0, static_cast<unsigned int>(bufferSizeInts), nullptr, buffer, 0, request);
+}
+
+void AsyncLink::wait(AsyncRequest& request)
+{
+    waitDone(request);
+    CAENComm_ErrorCode errVal = request.errVal;
+    request.errVal = CAENComm_Success;
+    throwOnError(errVal, request.moduleNumber);
+}
+
+void AsyncLink::waitAll(AsyncRequest* requests, int count)
+{
+    int firstFailed = -1;
+    CAENComm_ErrorCode firstErr = CAENComm_Success;
+    for(int i=0; i<count; ++i)
+    {
+        waitDone(requests[i]);
+        if(requests[i].errVal < 0)
+        {
+            if(firstFailed < 0)
+            {
+                firstFailed = i;
+                firstErr = requests[i].errVal;
+            }
+            else
+            {
+                countError(requests[i].errVal, requests[i].moduleNumber);
+            }
+        }
+        requests[i].errVal = CAENComm_Success;
+    }
+    if(firstFailed >= 0)
+    {
+        throwOnError(firstErr, requests[firstFailed].moduleNumber);
+    }
+}
+
+void AsyncLink::waitDone(AsyncRequest& request)
+{
+    AsyncBoardWorker* worker = request.worker;
+    if(worker == nullptr)
+    {
+        return;
+    }
+    {
+        boost::unique_lock<boost::mutex> lock(worker->queueMutex);
+        while(!request.done)
+        {
+            worker->doneCond.wait(lock);
+        }
+    }
+    request.worker = nullptr;
+}
+
+AsyncBoardWorker* AsyncLink::getWorker(int board)
+{
+    if((board < 0) || (static_cast<std::size_t>(board) >= boards.size()))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Async Link " << linkNumber << ": Request For Board " << board << " But The Link Has " << boards.size() << " Board(s)";
+        throw std::runtime_error("AsyncLink Error - Invalid Board Index");
+    }
+    return boards[static_cast<std::size_t>(board)];
+}
+
+void AsyncLink::submit(AsyncBoardWorker* worker, int type, unsigned int addr, unsigned int value,
+                       unsigned int* addrs, unsigned int* data, int count, AsyncRequest& request)
+{
+    if(request.worker != nullptr)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Async Link " << linkNumber << ": Request Record Reused Before It Was Waited On";
+        throw std::runtime_error("AsyncLink Error - Request Record Still In Use");
+    }
+    request.worker = worker;
+    request.done = false;
+    request.errVal = CAENComm_Success;
+    request.moduleNumber = worker->moduleNumber;
+    {
+        boost::unique_lock<boost::mutex> lock(worker->queueMutex);
+        while((worker->submitted - worker->taken) >= static_cast<unsigned long long>(AsyncRingSize))
+        {
+            worker->doneCond.wait(lock);
+        }
+        LinkRequest& slot = worker->ring[worker->submitted % AsyncRingSize];
+        slot.type = type;
+        slot.addr = addr;
+        slot.value = value;
+        slot.addrs = addrs;
+        slot.data = data;
+        slot.count = count;
+        slot.record = &request;
+        ++(worker->submitted);
+    }
+    worker->queueCond.notify_one();
+}
+
+void AsyncLink::workerLoop(AsyncBoardWorker* worker)
+{
+    using LowLvl::Vx1730ReadRegisters;
+    using LowLvl::Vx1730CommonReadRegistersAddr;
+    Utility::ThreadPlacement::pinCallingThread(worker->cpu);
+    while(true)
+    {
+        LinkRequest request;
+        {
+            boost::unique_lock<boost::mutex> lock(worker->queueMutex);
+            while((worker->submitted == worker->taken) && !worker->stopping)
+            {
+                worker->queueCond.wait(lock);
+            }
+            if(worker->submitted == worker->taken)
+            {
+                return;
+            }
+            request = worker->ring[worker->taken % AsyncRingSize];
+            ++(worker->taken);
+        }
+        //a slot just came free for anyone waiting to submit
+        worker->doneCond.notify_all();
+
+        CAENComm_ErrorCode errVal = CAENComm_Success;
+        unsigned int value = 0;
+        int wordsRead = 0;
+        switch(request.type)
+        {
+        case Read32Request:
+            errVal = CAENComm_Read32(worker->handle, request.addr, &value);
+            break;
+        case Write32Request:
+            errVal = CAENComm_Write32(worker->handle, request.addr, request.value);
+            break;
+        case MultiRead32Request:
+        case MultiWrite32Request:
+            if(request.type == MultiRead32Request)
+            {
+                errVal = CAENComm_MultiRead32(worker->handle, request.addrs, request.count, request.data, worker->cycleErrs);
+            }
+            else
+            {
+                errVal = CAENComm_MultiWrite32(worker->handle, request.addrs, request.count, request.data, worker->cycleErrs);
+            }
+            //a failed cycle is reported ahead of the overall code
+            for(int i=0; i<request.count; ++i)
+            {
+                if(worker->cycleErrs[i] < 0)
+                {
+                    errVal = worker->cycleErrs[i];
+                    break;
+                }
+            }
+            break;
+        case BlockReadRequest:
+            errVal = CAENComm_MBLTRead(worker->handle,
+                                       Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::EventReadout>::value,
+                                       request.data, static_cast<int>(request.value * 4), &wordsRead);
+            //a bus error is the normal end of a block transfer
+            if((errVal == CAENComm_VMEBusError) || (errVal == CAENComm_Terminated))
+            {
+                errVal = CAENComm_Success;
+            }
+            break;
+        default:
+            break;
+        }
+
+        {
+            boost::lock_guard<boost::mutex> lock(worker->queueMutex);
+            request.record->errVal = errVal;
+            request.record->value = value;
+            request.record->wordsRead = wordsRead;
+            request.record->done = true;
+        }
+        worker->doneCond.notify_all();
+    }
+}
+
+void AsyncLink::checkCycleCount(int count, int moduleNumber)
+{
+    if((count < 0) || (count > MultiRWArraySize))
+    {
+        std::ostringstream errText;
+        errText << "AsyncLink Error - " << count << " Registers In One Multi Cycle Transfer, At Most " << MultiRWArraySize << " Allowed (Digitizer #" << moduleNumber << ")";
+        throw std::runtime_error(errText.str());
+    }
+}
+
+void AsyncLink::countError(CAENComm_ErrorCode errVal, int moduleNumber)
+{
+    std::ostringstream labels;
+    labels << "board=\"" << moduleNumber << "\",code=\"" << static_cast<int>(errVal) << "\"";
+    Metrics::MetricsRegistry::get().addCounter("orchid_digitizer_errors_total", "CAENComm errors by digitizer and error code", labels.str())->add(1);
+}
+
+void AsyncLink::throwOnError(CAENComm_ErrorCode errVal, int moduleNumber)
+{
+    if(errVal < 0)
+    {
+        countError(errVal, moduleNumber);
+        std::ostringstream errText;
+        errText << "Vx1730 Error - " << Vx1730Digitizer::getErrorText(errVal) << " (Digitizer #" << moduleNumber << ")";
+        throw std::runtime_error(errText.str());
+    }
+}
+
+}
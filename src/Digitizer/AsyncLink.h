@@ -0,0 +1,130 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file AsyncLink.h
+** @author James Till Matta
+** @date 22 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the AsyncLink class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_DIGITIZER_ASYNCLINK_H
+#define ORCHID_SRC_DIGITIZER_ASYNCLINK_H
+// includes for C system headers
+// includes for C++ system headers
+#include<vector>
+// includes from other libraries
+#include<CAENComm.h>
+// includes from ORCHID
+#include"Utility/OrchidLogger.h"
+#include"Vx1730Digitizer.h"
+
+namespace Digitizer
+{
+
+//requests each board can have queued, a submit to a full ring waits for the
+//board's worker to take one
+enum {AsyncRingSize = 64};
+
+struct AsyncBoardWorker;
+
+//Completion record for one request, owned by the caller and filled in by the
+//  board's worker, like the arrays a request points at it must stay in place
+//  (so not in a vector that grows) until the request has been waited on
+//Waiting consumes the record, it can then be read and reused for another
+//  request, waiting on a record that was never submitted does nothing
+class AsyncRequest
+{
+public:
+    AsyncRequest() : worker(nullptr), done(true), errVal(CAENComm_Success),
+        moduleNumber(-1), value(0), wordsRead(0){}
+    AsyncRequest(const AsyncRequest&) = delete;
+    AsyncRequest& operator=(const AsyncRequest&) = delete;
+
+    //results, valid once the request has been waited on
+    unsigned int getValue(){return value;}
+    int getWordsRead(){return wordsRead;}
+
+private:
+    friend class AsyncLink;
+    AsyncBoardWorker* worker;
+    bool done;  //guarded by the worker's mutex
+    CAENComm_ErrorCode errVal;
+    int moduleNumber;
+    unsigned int value;
+    int wordsRead;
+};
+
+//Asynchronous front end to the CAENComm calls for the boards daisy chained on
+//  one optical link
+//Every CAENComm call blocks until its link round trip is done, so each board
+//  gets its own worker thread and request ring, requests to one board run in
+//  the order they were submitted while requests to different boards are in
+//  flight on the link at the same time and their latencies overlap
+//Requests are not pipelined within a board, a worker has one call out at a
+//  time, CAENComm offers no way to put a second one on the link before the
+//  first returns, and there is no scheduling across boards beyond one worker
+//  each, how much the boards' round trips overlap is up to CAENComm and the link
+//Submitting copies the request into a ring preallocated for the board and
+//  fills in a caller owned AsyncRequest when it completes, so no call touches
+//  the heap, errors are kept in the record and thrown by whoever waits on it
+//Arrays passed to the multi cycle and block read calls belong to the caller
+//  and must stay valid until the request is waited on, a multi cycle call can
+//  carry at most MultiRWArraySize registers, the per cycle error codes go in
+//  an array each worker owns since its requests never run at the same time
+//A board index that was not returned by addBoard, or a multi cycle call with
+//  too many registers, throws from the submitting call
+class AsyncLink
+{
+public:
+    AsyncLink(int linkNum);
+    ~AsyncLink();
+
+    //the cpu the board workers pin themselves to, -1 (the default) for any,
+    //only affects boards added after it is called
+    void setWorkerCpu(int cpuNum){workerCpu = cpuNum;}
+    //adds an already opened board, returns the index used to address it
+    int addBoard(int handle, int moduleNumber);
+    int getNumBoards(){return static_cast<int>(boards.size());}
+
+    void read32(int board, unsigned int addr, AsyncRequest& request);
+    void write32(int board, unsigned int addr, unsigned int value, AsyncRequest& request);
+    void multiRead32(int board, unsigned int* addrs, unsigned int* data, int count, AsyncRequest& request);
+    void multiWrite32(int board, unsigned int* addrs, unsigned int* data, int count, AsyncRequest& request);
+    void blockRead(int board, unsigned int* buffer, int bufferSizeInts, AsyncRequest& request);
+
+    //waits for one request, throwing if it failed
+    static void wait(AsyncRequest& request);
+    //waits on a set of requests, throwing the first error after all finish
+    static void waitAll(AsyncRequest* requests, int count);
+
+private:
+    AsyncBoardWorker* getWorker(int board);
+    void submit(AsyncBoardWorker* worker, int type, unsigned int addr, unsigned int value,
+                unsigned int* addrs, unsigned int* data, int count, AsyncRequest& request);
+    void workerLoop(AsyncBoardWorker* worker);
+    static void waitDone(AsyncRequest& request);
+    static void checkCycleCount(int count, int moduleNumber);
+    //bumps the error metric, every failure is counted even when only the
+    //first of a set is thrown
+    static void countError(CAENComm_ErrorCode errVal, int moduleNumber);
+    static void throwOnError(CAENComm_ErrorCode errVal, int moduleNumber);
+
+    int linkNumber;
+    int workerCpu;
+    std::vector<AsyncBoardWorker*> boards;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_DIGITIZER_ASYNCLINK_H
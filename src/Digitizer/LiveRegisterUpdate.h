@@ -0,0 +1,73 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file LiveRegisterUpdate.h
+** @author James Till Matta
+** @date 18 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Holds the description of a register change that can be made while
+** the digitizer is acquiring, and the queue used to hand them to the readout
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_DIGITIZER_LIVEREGISTERUPDATE_H
+#define ORCHID_SRC_DIGITIZER_LIVEREGISTERUPDATE_H
+
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+#include<boost/lockfree/spsc_queue.hpp>
+// includes from ORCHID
+
+namespace Digitizer
+{
+
+//only the per channel registers that can be touched without stopping the
+//board or losing its run state are listed here, anything else still has to
+//go through a full reset and restart
+enum class LiveRegister : unsigned char
+  { TrgThreshold, ShortGate, LongGate, GateOffset, PsdCutThreshold,
+    TrgHoldOff, ShapedTrgWidth};
+
+//channels on one V1730, a command naming anything else never reaches the queue
+enum {LiveUpdateQueueSize = 1024, LiveUpdateAllChannels = 0xFF, LiveUpdateBoardChannels = 16};
+
+//largest value the field of each live register holds, anything wider would
+//spill into the reserved bits above it
+inline unsigned int liveRegisterMaxValue(LiveRegister reg)
+{
+    switch(reg)
+    {
+    case LiveRegister::TrgThreshold:    return 0x3FFF;  //bits [13:0]
+    case LiveRegister::ShortGate:       return 0x0FFF;  //bits [11:0]
+    case LiveRegister::LongGate:        return 0xFFFF;  //bits [15:0]
+    case LiveRegister::GateOffset:      return 0x00FF;  //bits [7:0]
+    case LiveRegister::PsdCutThreshold: return 0x03FF;  //bits [9:0]
+    case LiveRegister::TrgHoldOff:      return 0xFFFF;  //bits [15:0]
+    case LiveRegister::ShapedTrgWidth:  return 0x03FF;  //bits [9:0]
+    default:                            return 0;
+    }
+}
+
+struct LiveRegisterUpdate
+{
+    unsigned int value;
+    LiveRegister reg;
+    unsigned char channel;  //channel on the board or LiveUpdateAllChannels
+    unsigned short address; //filled in by the digitizer when applied
+};
+
+//single producer (the command source) single consumer (the readout loop)
+//queue, both ends are wait free so the readout never blocks on it
+typedef boost::lockfree::spsc_queue<LiveRegisterUpdate, boost::lockfree::capacity<LiveUpdateQueueSize> > LiveUpdateQueue;
+
+}
+
+#endif //ORCHID_SRC_DIGITIZER_LIVEREGISTERUPDATE_H
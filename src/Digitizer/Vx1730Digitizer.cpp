@@ -20,31 +20,40 @@
 // includes for C system headers
 // includes for C++ system headers
 #include<iomanip>
+#include<sstream>
+#include<string>
 // includes from other libraries
 #include<boost/chrono.hpp>
 #include<boost/date_time/posix_time/posix_time.hpp>
 #include<boost/thread.hpp>
 // includes from ORCHID
 #include"Vx1730DigitizerRegisters.h"
+#include"Metrics/MetricsRegistry.h"
 
 namespace Digitizer
 {
 //TODO: Make names associated with the bits we set in registers
 //TODO: Maybe remove some of the error handling from CAENComm calls, it might be overkill
 
-enum {MultiRWArraySize = 320, IrqTimeoutMs = 5000};
+enum {IrqTimeoutMs = 5000, MaxBltInts = (1024*1024/4)};
 
-Vx1730Digitizer::Vx1730Digitizer() :
-    moduleNumber(0), channelStartInd(0), numChannel(16), digitizerHandle(0),
-    eventsPerInterrupt(0), acqRunning(false), digitizerOpen(false), addrArray(nullptr),
-    dataArray(nullptr), rdbkArray(nullptr), cycleErrsArray(nullptr),
-    arraySize(MultiRWArraySize), acquisitionCtrlRegBase(0), lg(OrchidLog::get())
+static const unsigned int AcqRunBit = 0x00000004;
+
+Vx1730Digitizer::Vx1730Digitizer() : Vx1730Digitizer(0, 0, 0)
 {
-    //allocate the multiread and multiwrite arrays
-    addrArray = new unsigned int[arraySize];
-    dataArray = new unsigned int[arraySize];
-    rdbkArray = new unsigned int[arraySize];
-    cycleErrsArray = new CAENComm_ErrorCode[arraySize];
+}
+
+Vx1730Digitizer::Vx1730Digitizer(int modNum, int linkNum, int nodeNum) :
+    moduleNumber(modNum), linkNumber(linkNum), conetNode(nodeNum),
+    channelStartInd(16*modNum), numChannel(16), digitizerHandle(0),
+    eventsPerInterrupt(0), acqRunning(false), digitizerOpen(false), addrArray(),
+    dataArray(), rdbkArray(), cycleErrsArray(), arraySize(MultiRWArraySize),
+    acquisitionCtrlRegBase(0), bytesReadMetric(nullptr), lg(OrchidLog::get())
+{
+    std::ostringstream labels;
+    labels << "board=\"" << moduleNumber << "\"";
+    bytesReadMetric = Metrics::MetricsRegistry::get().addCounter("orchid_bytes_read_total", "Bytes pulled from the digitizer by block transfers", labels.str());
+    //clear the multiread and multiwrite arrays
     for(int i=0; i<arraySize; ++i)
     {
         addrArray[i] = 0;
@@ -56,74 +65,42 @@ Vx1730Digitizer::Vx1730Digitizer() :
 
 Vx1730Digitizer::~Vx1730Digitizer()
 {
-    //delete the arrays we allocated
-    delete[] addrArray;
-    delete[] dataArray;
-    delete[] rdbkArray;
-    delete[] cycleErrsArray;
+    //so a digitizer dropped on the way out of an exception does not hold its link
+    this->closeDigitizer();
 }
 
 //log an error and throw an exception to close things
 void Vx1730Digitizer::writeErrorAndThrow(CAENComm_ErrorCode errVal)
+{
+    //this path ends in a throw so taking the registry lock here is fine
+    std::ostringstream labels;
+    labels << "board=\"" << moduleNumber << "\",code=\"" << static_cast<int>(errVal) << "\"";
+    Metrics::MetricsRegistry::get().addCounter("orchid_digitizer_errors_total", "CAENComm errors by digitizer and error code", labels.str())->add(1);
+    const char* errText = getErrorText(errVal);
+    BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: " << errText << "\n";
+    throw std::runtime_error(std::string("Vx1730 Error - ") + errText);
+}
+
+//the one table of CAENComm error descriptions, shared with the AsyncLink
+const char* Vx1730Digitizer::getErrorText(CAENComm_ErrorCode errVal)
 {
     switch(errVal)
     {
-    case CAENComm_Success:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Success\n";
-        throw std::runtime_error("Vx1730 Error - Success");
-        break;
-    case CAENComm_VMEBusError:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: VME Bus Error During Cycle\n";
-        throw std::runtime_error("Vx1730 Error - VME Bus Error During Cycle");
-        break;
-    case CAENComm_CommError:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Communication Error\n";
-        throw std::runtime_error("Vx1730 Error - Communication Error");
-        break;
-    case CAENComm_GenericError:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Unspecified Error\n";
-        throw std::runtime_error("Vx1730 Error - Unspecified Error");
-        break;
-    case CAENComm_InvalidParam:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Invalid Parameter\n";
-        throw std::runtime_error("Vx1730 Error - Invalid Parameter");
-        break;
-    case CAENComm_InvalidLinkType:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Invalid Link Type\n";
-        throw std::runtime_error("Vx1730 Error - Invalid Link Type");
-        break;
-    case CAENComm_InvalidHandler:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Invalid Device Handler\n";
-        throw std::runtime_error("Vx1730 Error - Invalid Device Handler");
-        break;
-    case CAENComm_CommTimeout:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Communication Timeout\n";
-        throw std::runtime_error("Vx1730 Error - Communication Timeout");
-        break;
-    case CAENComm_DeviceNotFound:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Unable To Open Requested Device\n";
-        throw std::runtime_error("Vx1730 Error - Unable To Open Requested Device");
-        break;
-    case CAENComm_MaxDevicesError:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Maximum Number of Devices Exceeded\n";
-        throw std::runtime_error("Vx1730 Error - Maximum Number of Devices Exceeded");
-        break;
-    case CAENComm_DeviceAlreadyOpen:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Device Already Open\n";
-        throw std::runtime_error("Vx1730 Error - Device Already Open");
-        break;
-    case CAENComm_NotSupported:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Not Supported Function\n";
-        throw std::runtime_error("Vx1730 Error - Not Supported Function");
-        break;
-    case CAENComm_UnusedBridge:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: There Are No Boards Controlled By That Bridge\n";
-        throw std::runtime_error("Vx1730 Error - There Are No Boards Controlled By That Bridge");
-        break;
-    case CAENComm_Terminated:
-        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Digitizer #" << moduleNumber << " - Code: Communication Terminated By Device\n";
-        throw std::runtime_error("Vx1730 Error - Communication Terminated By Device");
-        break;
+    case CAENComm_Success:          return "Success";
+    case CAENComm_VMEBusError:      return "VME Bus Error During Cycle";
+    case CAENComm_CommError:        return "Communication Error";
+    case CAENComm_GenericError:     return "Unspecified Error";
+    case CAENComm_InvalidParam:     return "Invalid Parameter";
+    case CAENComm_InvalidLinkType:  return "Invalid Link Type";
+    case CAENComm_InvalidHandler:   return "Invalid Device Handler";
+    case CAENComm_CommTimeout:      return "Communication Timeout";
+    case CAENComm_DeviceNotFound:   return "Unable To Open Requested Device";
+    case CAENComm_MaxDevicesError:  return "Maximum Number of Devices Exceeded";
+    case CAENComm_DeviceAlreadyOpen:return "Device Already Open";
+    case CAENComm_NotSupported:     return "Not Supported Function";
+    case CAENComm_UnusedBridge:     return "There Are No Boards Controlled By That Bridge";
+    case CAENComm_Terminated:       return "Communication Terminated By Device";
+    default:                        return "Unknown Error Code";
     }
 }
 
@@ -132,21 +109,9 @@ void Vx1730Digitizer::clearDigitizer()
     using LowLvl::Vx1730WriteRegisters;
     using LowLvl::Vx1730CommonWriteRegistersAddr;
     
-    //open the digitizer
-    CAENComm_ErrorCode errVal;
-    BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Opening VME Card Via Optical Link, Digitizer #" << moduleNumber;
-    errVal = CAENComm_OpenDevice(CAENComm_OpticalLink, 0, 0, 0x00000000,&(this->digitizerHandle));
-    
-    if (errVal < 0)
-    {
-        this->writeErrorAndThrow(errVal);
-    }
-    else
-    {
-        BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Successfully Opened Digitizer #" << moduleNumber;
-        digitizerOpen = true;
-    }
+    this->openDigitizer();
     
+    CAENComm_ErrorCode errVal;
     //hit the software reset to force the registers to default values
     errVal = CAENComm_Write32(digitizerHandle, Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::SoftwReset>::value, 0x00000000);
     if(errVal < 0)
@@ -169,18 +134,27 @@ void Vx1730Digitizer::clearDigitizer()
         this->writeErrorAndThrow(errVal);
     }
     
-    CAENComm_CloseDevice(this->digitizerHandle);
+    this->closeDigitizer();
 }
 
 void Vx1730Digitizer::readDigitizer()
 {
-    using LowLvl::Vx1730WriteRegisters;
-    using LowLvl::Vx1730CommonWriteRegistersAddr;
+    this->openDigitizer();
     
+    //now write all the registers
+    this->readCommonRegisterData();
+    this->readGroupRegisterData();
+    this->readIndividualRegisterData();
+    
+    this->closeDigitizer();
+}
+
+void Vx1730Digitizer::openDigitizer()
+{
     //open the digitizer
     CAENComm_ErrorCode errVal;
-    BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Opening VME Card Via Optical Link, Digitizer #" << moduleNumber;
-    errVal = CAENComm_OpenDevice(CAENComm_OpticalLink, 0, 0, 0x00000000,&(this->digitizerHandle));
+    BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Opening VME Card Via Optical Link " << linkNumber << " Node " << conetNode << ", Digitizer #" << moduleNumber;
+    errVal = CAENComm_OpenDevice(CAENComm_OpticalLink, linkNumber, conetNode, 0x00000000,&(this->digitizerHandle));
     
     if (errVal < 0)
     {
@@ -191,56 +165,253 @@ void Vx1730Digitizer::readDigitizer()
         BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Successfully Opened Digitizer #" << moduleNumber;
         digitizerOpen = true;
     }
+}
+
+void Vx1730Digitizer::closeDigitizer()
+{
+    if(digitizerOpen)
+    {
+        CAENComm_CloseDevice(this->digitizerHandle);
+        digitizerOpen = false;
+    }
+}
+
+void Vx1730Digitizer::startAcquisition()
+{
+    using LowLvl::Vx1730ReadRegisters;
+    using LowLvl::Vx1730CommonReadRegistersAddr;
+    //keep whatever acquisition mode bits are set and just add the run bit
+    acquisitionCtrlRegBase = (this->readSingleRegister(Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::AcquisitionCtrl>::value) & (~AcqRunBit));
+    this->writeSingleRegister(Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::AcquisitionCtrl>::value, (acquisitionCtrlRegBase | AcqRunBit));
+    acqRunning = true;
+    BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Started Acquisition On Digitizer #" << moduleNumber;
+}
+
+void Vx1730Digitizer::stopAcquisition()
+{
+    using LowLvl::Vx1730ReadRegisters;
+    using LowLvl::Vx1730CommonReadRegistersAddr;
+    using LowLvl::Vx1730WriteRegisters;
+    using LowLvl::Vx1730CommonWriteRegistersAddr;
+    //without a start there is no saved mode to go back to, so take the
+    //register as the board has it and just clear the run bit
+    unsigned int ctrlValue = acquisitionCtrlRegBase;
+    if(!acqRunning)
+    {
+        ctrlValue = (this->readSingleRegister(Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::AcquisitionCtrl>::value) & (~AcqRunBit));
+    }
+    this->writeSingleRegister(Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AcquisitionCtrl>::value, ctrlValue);
+    acqRunning = false;
+    BOOST_LOG_SEV(lg, Information) << "ACQ Thread: Stopped Acquisition On Digitizer #" << moduleNumber;
+}
+
+void Vx1730Digitizer::fireSoftwareTrigger()
+{
+    using LowLvl::Vx1730WriteRegisters;
+    using LowLvl::Vx1730CommonWriteRegistersAddr;
+    this->writeSingleRegister(Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::SoftwareTrg>::value, 0x00000001);
+}
+
+void Vx1730Digitizer::fireIndividualSoftwareTrigger(int channel)
+{
+    using LowLvl::Vx1730WriteRegisters;
+    using LowLvl::Vx1730IndivWriteRegistersAddr;
+    using LowLvl::Vx1730IndivWriteRegistersOffs;
+    using LowLvl::Vx1730IbcastWriteRegistersAddr;
+    if(channel < 0)
+    {
+        this->writeSingleRegister(Vx1730IbcastWriteRegistersAddr<Vx1730WriteRegisters::IndivSoftwTrig>::value, 0x00000001);
+        return;
+    }
+    if(channel >= numChannel)
+    {
+        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Channel " << channel << " Out Of Range For Individual Software Trigger On Digitizer #" << moduleNumber;
+        throw std::runtime_error("Vx1730 Error - Individual Software Trigger Channel Out Of Range");
+    }
+    this->writeSingleRegister((Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::IndivSoftwTrig>::value +
+                               (channel * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::IndivSoftwTrig>::value)), 0x00000001);
+}
+
+void Vx1730Digitizer::setAllTriggerThresholds(unsigned int threshold)
+{
+    using LowLvl::Vx1730WriteRegisters;
+    using LowLvl::Vx1730IbcastWriteRegistersAddr;
+    //use the broadcast address to hit every channel in one cycle
+    this->writeSingleRegister(Vx1730IbcastWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value, (threshold & 0x00003FFF));
+}
+
+unsigned int Vx1730Digitizer::readAcquisitionStatus()
+{
+    using LowLvl::Vx1730ReadRegisters;
+    using LowLvl::Vx1730CommonReadRegistersAddr;
+    return this->readSingleRegister(Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::AcqusitionStatus>::value);
+}
+
+unsigned int Vx1730Digitizer::readEventSize()
+{
+    using LowLvl::Vx1730ReadRegisters;
+    using LowLvl::Vx1730CommonReadRegistersAddr;
+    return this->readSingleRegister(Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::EventSize>::value);
+}
+
+unsigned int Vx1730Digitizer::readReadoutStatus()
+{
+    using LowLvl::Vx1730ReadRegisters;
+    using LowLvl::Vx1730CommonReadRegistersAddr;
+    return this->readSingleRegister(Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::ReadoutStatus>::value);
+}
+
+//pulls block transfers until the board runs dry or the buffer is full,
+//returns the number of 32 bit words placed in the buffer
+int Vx1730Digitizer::readEvents(unsigned int* buffer, int bufferSizeInts)
+{
+    using LowLvl::Vx1730ReadRegisters;
+    using LowLvl::Vx1730CommonReadRegistersAddr;
+    int totalWords = 0;
+    int wordsRead = 0;
+    do
+    {
+        int remainingInts = (bufferSizeInts - totalWords);
+        int bltInts = ((remainingInts < MaxBltInts) ? remainingInts : MaxBltInts);
+        if(bltInts <= 0)
+        {
+            break;
+        }
+        wordsRead = 0;
+        CAENComm_ErrorCode errVal = CAENComm_MBLTRead(this->digitizerHandle,
+                                                      Vx1730CommonReadRegistersAddr<Vx1730ReadRegisters::EventReadout>::value,
+                                                      buffer + totalWords, (bltInts * 4), &wordsRead);
+        //a bus error is how the board ends a block transfer when it runs out
+        //of data, so it is not treated as a failure
+        if((errVal < 0) && (errVal != CAENComm_VMEBusError) && (errVal != CAENComm_Terminated))
+        {
+            BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Error In Block Transfer From Digitizer #" << moduleNumber;
+            this->writeErrorAndThrow(errVal);
+        }
+        totalWords += wordsRead;
+    }
+    while(wordsRead > 0);
+    bytesReadMetric->add(4ULL * static_cast<unsigned long long>(totalWords));
+    return totalWords;
+}
+
+int Vx1730Digitizer::applyLiveUpdates(LiveUpdateQueue& queue, LiveRegisterUpdate* applied, int maxUpdates)
+{
+    int limit = ((maxUpdates < arraySize) ? maxUpdates : arraySize);
+    int regCount = 0;
+    LiveRegisterUpdate update;
+    while((regCount < limit) && queue.pop(update))
+    {
+        //the command reader rejects (and logs) bad channels, this only keeps a
+        //stray one from computing an address, no log record in the readout
+        if((update.channel >= numChannel) && (update.channel != LiveUpdateAllChannels))
+        {
+            continue;
+        }
+        update.address = this->liveRegisterAddress(update.reg, update.channel);
+        addrArray[regCount] = update.address;
+        dataArray[regCount] = update.value;
+        applied[regCount] = update;
+        ++regCount;
+    }
+    if(regCount == 0)
+    {
+        return 0;
+    }
     
-    //now write all the registers
-    this->readCommonRegisterData();
-    this->readGroupRegisterData();
-    this->readIndividualRegisterData();
+    CAENComm_ErrorCode overallErr = CAENComm_MultiWrite32(this->digitizerHandle,
+                                                          addrArray, regCount,
+                                                          dataArray, cycleErrsArray);
+    //test for errors in the individual cycles
+    for(int i=0; i<regCount; ++i)
+    {
+        if(cycleErrsArray[i] < 0)
+        {
+            BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Error In Live Write To Address: 0x" << std::hex << std::setw(4) << std::setfill('0') << addrArray[i] << std::dec;
+            this->writeErrorAndThrow(cycleErrsArray[i]);
+        }
+    }
     
-    CAENComm_CloseDevice(this->digitizerHandle);
+    //test for an overall error
+    if(overallErr < 0)
+    {
+        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Overall Error In Live Register Writes for Digitizer #" << moduleNumber;
+        this->writeErrorAndThrow(overallErr);
+    }
+    return regCount;
 }
 
-void Vx1730Digitizer::readCommonRegisterData()
+unsigned short Vx1730Digitizer::liveRegisterAddress(LiveRegister reg, int channel)
 {
     using LowLvl::Vx1730WriteRegisters;
-    using LowLvl::Vx1730CommonWriteRegistersAddr;
-    int regCount=0;
-    //set the components of the address and data arrays
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::BoardConfig>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AggregateOrg>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AcquisitionCtrl>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::GlobalTrgMask>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::TrgOutEnMask>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::FrontIoCtrl>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::ChanEnMask>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::SetMonitorDac>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::MonitorDacMode>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::MemBuffAlmtFullLvl>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::RunStrtStpDelay>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::DisableExtTrig>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::FrontLvdsIoNew>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::ReadoutCtrl>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::InterruptStatID>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::InterruptEventNum>::value;
-    ++regCount;
-    addrArray[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AggregateNumPerBlt>::value;
-    ++regCount;
+    using LowLvl::Vx1730IndivWriteRegistersAddr;
+    using LowLvl::Vx1730IndivWriteRegistersOffs;
+    using LowLvl::Vx1730IbcastWriteRegistersAddr;
+    //the broadcast addresses sit at the same offsets as the channel 0
+    //addresses, just moved up from 0x1000 to 0x8000
+    static const unsigned short BroadcastShift = (Vx1730IbcastWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value -
+                                                  Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value);
+    unsigned short baseAddr = 0;
+    switch(reg)
+    {
+    case LiveRegister::TrgThreshold:
+        baseAddr = Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value;
+        break;
+    case LiveRegister::ShortGate:
+        baseAddr = Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::ShortGate>::value;
+        break;
+    case LiveRegister::LongGate:
+        baseAddr = Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::LongGate>::value;
+        break;
+    case LiveRegister::GateOffset:
+        baseAddr = Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::GateOffset>::value;
+        break;
+    case LiveRegister::PsdCutThreshold:
+        baseAddr = Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::PsdCutThreshold>::value;
+        break;
+    case LiveRegister::TrgHoldOff:
+        baseAddr = Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgHoldOff>::value;
+        break;
+    case LiveRegister::ShapedTrgWidth:
+        baseAddr = Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::ShapedTrgWidth>::value;
+        break;
+    default:
+        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Unknown Live Register " << static_cast<int>(reg) << " For Digitizer #" << moduleNumber;
+        throw std::runtime_error("Vx1730 Error - Unknown Live Register");
+    }
+    if(channel == LiveUpdateAllChannels)
+    {
+        return static_cast<unsigned short>(baseAddr + BroadcastShift);
+    }
+    return static_cast<unsigned short>(baseAddr + (channel * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::TrgThreshold>::value));
+}
+
+unsigned int Vx1730Digitizer::readSingleRegister(unsigned int addr)
+{
+    unsigned int value = 0;
+    CAENComm_ErrorCode errVal = CAENComm_Read32(this->digitizerHandle, addr, &value);
+    if(errVal < 0)
+    {
+        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Error Reading Address: 0x" << std::hex << std::setw(4) << std::setfill('0') << addr << std::dec << " In Digitizer #" << moduleNumber;
+        this->writeErrorAndThrow(errVal);
+    }
+    return value;
+}
+
+void Vx1730Digitizer::writeSingleRegister(unsigned int addr, unsigned int value)
+{
+    CAENComm_ErrorCode errVal = CAENComm_Write32(this->digitizerHandle, addr, value);
+    if(errVal < 0)
+    {
+        BOOST_LOG_SEV(lg, Error) << "ACQ Thread: Error Writing Address: 0x" << std::hex << std::setw(4) << std::setfill('0') << addr << std::dec << " In Digitizer #" << moduleNumber;
+        this->writeErrorAndThrow(errVal);
+    }
+}
 
+void Vx1730Digitizer::readCommonRegisterData()
+{
+    int regCount = this->fillCommonRegisterAddresses(addrArray);
+    
     //perform a readback to be certain of integrity
     for(int i=0; i<regCount; ++i)
     {
@@ -277,27 +448,7 @@ void Vx1730Digitizer::readCommonRegisterData()
 
 void Vx1730Digitizer::readGroupRegisterData()
 {
-    using LowLvl::Vx1730WriteRegisters;
-    using LowLvl::Vx1730GroupWriteRegistersAddr;
-    using LowLvl::Vx1730GroupWriteRegistersOffs;
-    int regCount=0;
-    for(int i=0; i<this->numChannel; i+=2)
-    {
-        addrArray[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::RecordLength>::value +
-                               (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::RecordLength>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::EventsPerAggregate>::value +
-                               (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::EventsPerAggregate>::value));
-        ++regCount;
-        
-        addrArray[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::LocalTrgManage>::value +
-                               (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::LocalTrgManage>::value));
-        ++regCount;
-        
-        addrArray[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::TriggerValMask>::value +
-                               (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::TriggerValMask>::value));
-        ++regCount;
-    }
+    int regCount = this->fillGroupRegisterAddresses(addrArray);
     
     //perform a readback to be certain of integrity
     for(int i=0; i<regCount; ++i)
@@ -335,56 +486,7 @@ void Vx1730Digitizer::readGroupRegisterData()
 
 void Vx1730Digitizer::readIndividualRegisterData()
 {
-    using LowLvl::Vx1730WriteRegisters;
-    using LowLvl::Vx1730IndivWriteRegistersAddr;
-    using LowLvl::Vx1730IndivWriteRegistersOffs;
-    int regCount=0;
-    int stopInd = this->channelStartInd + this->numChannel;
-    for(int i=channelStartInd; i<stopInd; ++i)
-    {
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::InputDynamicRange>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::InputDynamicRange>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::PreTrg>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::PreTrg>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::CfdSettings>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::CfdSettings>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::ShortGate>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::ShortGate>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::LongGate>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::LongGate>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::GateOffset>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::GateOffset>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::TrgThreshold>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::FixedBaseline>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::FixedBaseline>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::ShapedTrgWidth>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::ShapedTrgWidth>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgHoldOff>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::TrgHoldOff>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::PsdCutThreshold>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::PsdCutThreshold>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DppAlgorithmCtrl>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::DppAlgorithmCtrl>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DcOffset>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::DcOffset>::value));
-        ++regCount;
-        addrArray[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::VetoExtension>::value +
-                               ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::VetoExtension>::value));
-        ++regCount;
-    }
+    int regCount = this->fillIndividualRegisterAddresses(addrArray);
     
     //perform a readback to be certain of integrity
     for(int i=0; i<regCount; ++i)
@@ -420,4 +522,129 @@ void Vx1730Digitizer::readIndividualRegisterData()
     }
 }
 
+int Vx1730Digitizer::fillCommonRegisterAddresses(unsigned int* addrs)
+{
+    using LowLvl::Vx1730WriteRegisters;
+    using LowLvl::Vx1730CommonWriteRegistersAddr;
+    int regCount=0;
+    //set the components of the address and data arrays
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::BoardConfig>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AggregateOrg>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AcquisitionCtrl>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::GlobalTrgMask>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::TrgOutEnMask>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::FrontIoCtrl>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::ChanEnMask>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::SetMonitorDac>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::MonitorDacMode>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::MemBuffAlmtFullLvl>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::RunStrtStpDelay>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::DisableExtTrig>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::FrontLvdsIoNew>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::ReadoutCtrl>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::InterruptStatID>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::InterruptEventNum>::value;
+    ++regCount;
+    addrs[regCount] = Vx1730CommonWriteRegistersAddr<Vx1730WriteRegisters::AggregateNumPerBlt>::value;
+    ++regCount;
+    return regCount;
+}
+
+int Vx1730Digitizer::fillGroupRegisterAddresses(unsigned int* addrs)
+{
+    using LowLvl::Vx1730WriteRegisters;
+    using LowLvl::Vx1730GroupWriteRegistersAddr;
+    using LowLvl::Vx1730GroupWriteRegistersOffs;
+    int regCount=0;
+    int stopInd = this->channelStartInd + this->numChannel;
+    for(int i=channelStartInd; i<stopInd; i+=2)
+    {
+        addrs[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::RecordLength>::value +
+                           (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::RecordLength>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::EventsPerAggregate>::value +
+                           (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::EventsPerAggregate>::value));
+        ++regCount;
+        
+        addrs[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::LocalTrgManage>::value +
+                           (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::LocalTrgManage>::value));
+        ++regCount;
+        
+        addrs[regCount] = (Vx1730GroupWriteRegistersAddr<Vx1730WriteRegisters::TriggerValMask>::value +
+                           (((i-channelStartInd)/2) * Vx1730GroupWriteRegistersOffs<Vx1730WriteRegisters::TriggerValMask>::value));
+        ++regCount;
+    }
+    return regCount;
+}
+
+int Vx1730Digitizer::fillIndividualRegisterAddresses(unsigned int* addrs)
+{
+    using LowLvl::Vx1730WriteRegisters;
+    using LowLvl::Vx1730IndivWriteRegistersAddr;
+    using LowLvl::Vx1730IndivWriteRegistersOffs;
+    int regCount=0;
+    int stopInd = this->channelStartInd + this->numChannel;
+    for(int i=channelStartInd; i<stopInd; ++i)
+    {
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::InputDynamicRange>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::InputDynamicRange>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::PreTrg>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::PreTrg>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::CfdSettings>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::CfdSettings>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::ShortGate>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::ShortGate>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::LongGate>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::LongGate>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::GateOffset>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::GateOffset>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgThreshold>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::TrgThreshold>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::FixedBaseline>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::FixedBaseline>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::ShapedTrgWidth>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::ShapedTrgWidth>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::TrgHoldOff>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::TrgHoldOff>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::PsdCutThreshold>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::PsdCutThreshold>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DppAlgorithmCtrl>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::DppAlgorithmCtrl>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::DcOffset>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::DcOffset>::value));
+        ++regCount;
+        addrs[regCount] = (Vx1730IndivWriteRegistersAddr<Vx1730WriteRegisters::VetoExtension>::value +
+                           ((i-channelStartInd) * Vx1730IndivWriteRegistersOffs<Vx1730WriteRegisters::VetoExtension>::value));
+        ++regCount;
+    }
+    return regCount;
+}
+
 }
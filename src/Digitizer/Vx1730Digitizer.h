@@ -24,9 +24,14 @@
 #include<CAENComm.h>
 // includes from ORCHID
 #include"Utility/OrchidLogger.h"
+#include"Metrics/Metric.h"
+#include"LiveRegisterUpdate.h"
 
 namespace Digitizer
 {
+
+enum {MultiRWArraySize = 320};
+
 //Todo: add some mechanism to reduce the number of individual channel reads
 //  while acquiring data, maybe use the number of aggregates to trigger an IRQ
 //  as a bare minimum to wait for?
@@ -34,30 +39,72 @@ class Vx1730Digitizer
 {
 public:
     Vx1730Digitizer();
+    Vx1730Digitizer(int modNum, int linkNum, int nodeNum);
     ~Vx1730Digitizer();
     
     void readDigitizer();
     void clearDigitizer();
+    
+    //lower level access used by the test modes
+    void openDigitizer();
+    void closeDigitizer();
+    void startAcquisition();
+    void stopAcquisition();
+    void fireSoftwareTrigger();
+    //fires the individual software trigger of one channel, or of every
+    //channel at once through the broadcast address if channel is negative
+    void fireIndividualSoftwareTrigger(int channel);
+    void setAllTriggerThresholds(unsigned int threshold);
+    unsigned int readAcquisitionStatus();
+    unsigned int readEventSize();
+    unsigned int readReadoutStatus();
+    int readEvents(unsigned int* buffer, int bufferSizeInts);
+    //applies queued register changes between block transfers, returns the
+    //number applied and copies them (with addresses) into applied
+    int applyLiveUpdates(LiveUpdateQueue& queue, LiveRegisterUpdate* applied, int maxUpdates);
+    
+    int getModuleNumber(){return moduleNumber;}
+    int getChannelStartInd(){return channelStartInd;}
+    int getHandle(){return digitizerHandle;}
+    
+    //fill an array with the addresses of each register class that the
+    //readback reads, returning how many were placed
+    int fillCommonRegisterAddresses(unsigned int* addrs);
+    int fillGroupRegisterAddresses(unsigned int* addrs);
+    int fillIndividualRegisterAddresses(unsigned int* addrs);
+    
+    //human readable description of a CAENComm error code
+    static const char* getErrorText(CAENComm_ErrorCode errVal);
+    //boards are numbered across all the links, link by link, with every link
+    //carrying the same number of boards, so that channel numbers and metric
+    //labels are unique across links
+    static int globalModuleNumber(int linkNum, int boardsPerLink, int slot){return ((linkNum * boardsPerLink) + slot);}
 
 private:
-    void writeErrorAndThrow(CAENComm_ErrorCode errVal);
+    [[noreturn]] void writeErrorAndThrow(CAENComm_ErrorCode errVal);
     
     void readCommonRegisterData();
     void readGroupRegisterData();
     void readIndividualRegisterData();
+    unsigned int readSingleRegister(unsigned int addr);
+    void writeSingleRegister(unsigned int addr, unsigned int value);
+    unsigned short liveRegisterAddress(LiveRegister reg, int channel);
     
     int moduleNumber;
+    int linkNumber;
+    int conetNode;
     int channelStartInd;
     int numChannel;
     int digitizerHandle;
     int eventsPerInterrupt;
     bool acqRunning;
     bool digitizerOpen;
-    //arrays to handle multireads and multi writes
-    unsigned int* addrArray;
-    unsigned int* dataArray;
-    unsigned int* rdbkArray;
-    CAENComm_ErrorCode* cycleErrsArray;
+    //arrays to handle multireads and multi writes, held in the object so
+    //nothing is allocated once the digitizer exists
+    unsigned int addrArray[MultiRWArraySize];
+    unsigned int dataArray[MultiRWArraySize];
+    unsigned int rdbkArray[MultiRWArraySize];
+    CAENComm_ErrorCode cycleErrsArray[MultiRWArraySize];
     int arraySize;
     //variables to hold sizes of parts of the readout (in 32 bit ints
     int sizePerEvent[8];
@@ -67,6 +114,7 @@ private:
     int maxBufferFillForAnotherRead;
     //variables to hold persistent values for use later
     unsigned int acquisitionCtrlRegBase;
+    Metrics::MetricCounter* bytesReadMetric;
     
     boost::log::sources::severity_logger_mt<LogSeverity>& lg;
     
@@ -0,0 +1,55 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file DppPsdEvent.h
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Holds the definition of a single parsed DPP_PSD event
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_EVENTS_DPPPSDEVENT_H
+#define ORCHID_SRC_EVENTS_DPPPSDEVENT_H
+
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+
+namespace Events
+{
+
+//records with these in the board field are not events but markers of a live
+//register change, each change is written as a pair, first ConfigChangeMarker
+//then ConfigChangeBoardTime, for both: channel = board channel (0xFF for all),
+//longCharge = register address, shortCharge = low 16 bits of the value,
+//baseline = high 16 bits of the value
+//ConfigChangeMarker: timeStamp = wall clock time in ns since the epoch
+//ConfigChangeBoardTime: timeStamp = the newest event time stamp (clock ticks)
+//  parsed from the board before the change was written, the markers skip the
+//  sorter and filter so this, not their place in the file, is what places the
+//  change among the events
+enum {ConfigChangeMarker = 0xFF, ConfigChangeBoardTime = 0xFE};
+
+//kept to 16 bytes so that a batch of events packs densely in the buffers
+struct DppPsdEvent
+{
+    unsigned long long timeStamp;   //trigger time tag (with extension) in clock ticks
+    unsigned short longCharge;      //long gate integral
+    unsigned short shortCharge;     //short gate integral
+    unsigned short baseline;        //baseline value (only valid if extras are on)
+    unsigned char channel;          //global channel index, channelStartInd + chan
+    unsigned char board;            //module number of the originating digitizer
+};
+
+}
+
+#endif //ORCHID_SRC_EVENTS_DPPPSDEVENT_H
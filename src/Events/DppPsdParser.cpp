@@ -0,0 +1,141 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file DppPsdParser.cpp
+** @author James Till Matta
+** @date 18 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the DppPsdParser class
+**
+********************************************************************************
+*******************************************************************************/
+#include"DppPsdParser.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<sstream>
+// includes from other libraries
+// includes from ORCHID
+#include"Metrics/MetricsRegistry.h"
+
+namespace Events
+{
+
+enum {BoardAggHeaderInts = 4, ChanAggHeaderInts = 2};
+
+DppPsdParser::DppPsdParser(EventSink* nextStage, int boardNumber, int firstChannel) :
+    next(nextStage), board(boardNumber), channelStartInd(firstChannel),
+    eventsParsed(0), parseErrors(0), latestTimeStamp(0), aggregatesMetric(nullptr), eventsMetric(nullptr),
+    errorsMetric(nullptr), lg(OrchidLog::get())
+{
+    std::ostringstream labels;
+    labels << "board=\"" << board << "\"";
+    Metrics::MetricsRegistry& registry = Metrics::MetricsRegistry::get();
+    aggregatesMetric = registry.addCounter("orchid_board_aggregates_total", "Board aggregates parsed from the readout", labels.str());
+    eventsMetric = registry.addCounter("orchid_events_parsed_total", "Events parsed from the readout", labels.str());
+    errorsMetric = registry.addCounter("orchid_parse_errors_total", "Malformed aggregate headers found by the parser", labels.str());
+}
+
+int DppPsdParser::parseBuffer(const unsigned int* buffer, int sizeInInts)
+{
+    int eventCount = 0;
+    int aggCount = 0;
+    int offset = 0;
+    while(offset < sizeInInts)
+    {
+        //board aggregate header word 0: [31:28] = 0xA, [27:0] = size in ints
+        int aggSize = static_cast<int>(buffer[offset] & 0x0FFFFFFFUL);
+        if(((buffer[offset] >> 28) != 0x0A) || (aggSize < BoardAggHeaderInts) || ((offset + aggSize) > sizeInInts))
+        {
+            //without a valid header we cannot find the next aggregate, give up on the buffer
+            ++parseErrors;
+            errorsMetric->add(1);
+            BOOST_LOG_SEV(lg, Error) << "Parser: Bad Board Aggregate Header For Digitizer #" << board << " At Offset " << offset << " Of " << sizeInInts;
+            break;
+        }
+        eventCount += this->parseBoardAggregate(buffer + offset, aggSize);
+        offset += aggSize;
+        ++aggCount;
+    }
+    eventsParsed += static_cast<unsigned long long>(eventCount);
+    aggregatesMetric->add(static_cast<unsigned long long>(aggCount));
+    eventsMetric->add(static_cast<unsigned long long>(eventCount));
+    return eventCount;
+}
+
+int DppPsdParser::parseBoardAggregate(const unsigned int* buffer, int sizeInInts)
+{
+    int eventCount = 0;
+    //board aggregate header word 1: [7:0] = mask of couples with data
+    unsigned int coupleMask = (buffer[1] & 0x000000FFUL);
+    int offset = BoardAggHeaderInts;
+    for(int i=0; i<8; ++i)
+    {
+        if(((coupleMask >> i) & 0x1UL) == 0)
+        {
+            continue;
+        }
+        //channel aggregate header word 0: [31] = 1, [21:0] = size in ints
+        int chanSize = static_cast<int>(buffer[offset] & 0x003FFFFFUL);
+        if(((buffer[offset] >> 31) != 0x1) || (chanSize < ChanAggHeaderInts) || ((offset + chanSize) > sizeInInts))
+        {
+            ++parseErrors;
+            errorsMetric->add(1);
+            BOOST_LOG_SEV(lg, Error) << "Parser: Bad Channel Aggregate Header For Digitizer #" << board << " Couple " << i;
+            break;
+        }
+        eventCount += this->parseChannelAggregate(buffer + offset, chanSize, i);
+        offset += chanSize;
+    }
+    return eventCount;
+}
+
+int DppPsdParser::parseChannelAggregate(const unsigned int* buffer, int sizeInInts, int couple)
+{
+    //channel aggregate header word 1 holds the format of the events
+    //[28] = extras present, [27] = samples present, [26:24] = extras option,
+    //[23:22] = analog probe, [21:19] and [18:16] = digital probes,
+    //[15:0] = number of samples / 8
+    unsigned int format = buffer[1];
+    int extrasOn = static_cast<int>((format >> 28) & 0x1UL);
+    int samplesOn = static_cast<int>((format >> 27) & 0x1UL);
+    unsigned int extrasOption = ((format >> 24) & 0x7UL);
+    int sampleInts = (samplesOn * static_cast<int>(format & 0xFFFFUL) * 4);
+    int eventSize = (2 + sampleInts + extrasOn);
+    int coupleChannel = (channelStartInd + (2 * couple));
+
+    int eventCount = 0;
+    DppPsdEvent event;
+    for(int offset = ChanAggHeaderInts; (offset + eventSize) <= sizeInInts; offset += eventSize)
+    {
+        //word 0: [31] = odd channel of the couple, [30:0] = trigger time tag
+        unsigned int timeWord = buffer[offset];
+        unsigned int extras = (extrasOn ? buffer[offset + 1 + sampleInts] : 0);
+        //last word: [31:16] = long charge, [15] = pileup, [14:0] = short charge
+        unsigned int charge = buffer[offset + eventSize - 1];
+        //extras options 0-2 carry the time stamp extension in [31:16], option 0
+        //carries 4 * baseline in [15:0]
+        unsigned long long extTime = ((extrasOption <= 2) ? (extras >> 16) : 0);
+        event.timeStamp = ((extTime << 31) | (timeWord & 0x7FFFFFFFUL));
+        event.longCharge = static_cast<unsigned short>(charge >> 16);
+        event.shortCharge = static_cast<unsigned short>(charge & 0x7FFFUL);
+        event.baseline = static_cast<unsigned short>((extrasOption == 0) ? ((extras & 0xFFFFUL) >> 2) : 0);
+        event.channel = static_cast<unsigned char>(coupleChannel + static_cast<int>(timeWord >> 31));
+        event.board = static_cast<unsigned char>(board);
+        if(event.timeStamp > latestTimeStamp)
+        {
+            latestTimeStamp = event.timeStamp;
+        }
+        next->acceptEvent(event);
+        ++eventCount;
+    }
+    return eventCount;
+}
+
+}
@@ -0,0 +1,69 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file DppPsdParser.h
+** @author James Till Matta
+** @date 18 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the DppPsdParser class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_EVENTS_DPPPSDPARSER_H
+#define ORCHID_SRC_EVENTS_DPPPSDPARSER_H
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+#include"EventSink.h"
+#include"Metrics/Metric.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Events
+{
+
+//Breaks the board aggregates pulled off a Vx1730 running DPP_PSD firmware
+//into individual events and hands them to the next stage
+//Events come out in the order they sit in the buffer, which is only time
+//ordered within a single channel
+class DppPsdParser
+{
+public:
+    DppPsdParser(EventSink* nextStage, int boardNumber, int firstChannel);
+    ~DppPsdParser(){}
+
+    //returns the number of events found in the buffer
+    int parseBuffer(const unsigned int* buffer, int sizeInInts);
+
+    unsigned long long getEventsParsed(){return eventsParsed;}
+    unsigned long long getParseErrors(){return parseErrors;}
+    //the largest event time stamp parsed so far, in clock ticks
+    unsigned long long getLatestTimeStamp(){return latestTimeStamp;}
+
+private:
+    int parseBoardAggregate(const unsigned int* buffer, int sizeInInts);
+    int parseChannelAggregate(const unsigned int* buffer, int sizeInInts, int couple);
+
+    EventSink* next;
+    int board;
+    int channelStartInd;
+    unsigned long long eventsParsed;
+    unsigned long long parseErrors;
+    unsigned long long latestTimeStamp;
+    Metrics::MetricCounter* aggregatesMetric;
+    Metrics::MetricCounter* eventsMetric;
+    Metrics::MetricCounter* errorsMetric;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_EVENTS_DPPPSDPARSER_H
@@ -0,0 +1,45 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file EventSink.h
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Interface for the stages that time ordered events are pushed
+** through on their way to disk
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_EVENTS_EVENTSINK_H
+#define ORCHID_SRC_EVENTS_EVENTSINK_H
+
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+#include"DppPsdEvent.h"
+
+namespace Events
+{
+
+class EventSink
+{
+public:
+    virtual ~EventSink(){}
+    
+    //hands a single event to the stage, events must arrive in time order
+    virtual void acceptEvent(const DppPsdEvent& event) = 0;
+    //forces the stage to push anything it is holding to the next stage
+    virtual void flush() = 0;
+};
+
+}
+
+#endif //ORCHID_SRC_EVENTS_EVENTSINK_H
@@ -0,0 +1,289 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ChainConfig.cpp
+** @author James Till Matta
+** @date 20 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the ChainConfig class
+**
+********************************************************************************
+*******************************************************************************/
+#include"ChainConfig.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<fstream>
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+
+namespace Filter
+{
+
+ChainConfig::ChainConfig() : coincWindow(0), vetoWindow(0),
+    writeVetoChannels(false), lg(OrchidLog::get())
+{
+    for(int i=0; i<MaxFilterChannels; ++i)
+    {
+        channelGroup[i] = -1;
+        isVetoChannel[i] = 0;
+        isVetoed[i] = 0;
+    }
+    for(int i=0; i<MaxCoincGroups; ++i)
+    {
+        groupMultiplicity[i] = 0;
+    }
+    for(int i=0; i<MaxReducerChannels; ++i)
+    {
+        prescale[i] = 1;
+        chargeThreshold[i] = 0;
+        histOnly[i] = 0;
+    }
+}
+
+bool ChainConfig::readFile(const std::string& fileName, bool mustExist)
+{
+    std::ifstream inFile(fileName.c_str());
+    if(!inFile.is_open())
+    {
+        if(mustExist)
+        {
+            BOOST_LOG_SEV(lg, Error) << "Chain Config: Could Not Open Filter Config File: " << fileName;
+            throw std::runtime_error("ChainConfig Error - Could Not Open Filter Config File");
+        }
+        BOOST_LOG_SEV(lg, Warning) << "Chain Config: No Filter Config File At: " << fileName << ", Every Event Will Be Written";
+        return false;
+    }
+    std::string line;
+    int lineNum = 0;
+    while(std::getline(inFile, line))
+    {
+        ++lineNum;
+        std::size_t start = line.find_first_not_of(" \t");
+        if((start == std::string::npos) || (line[start] == '#'))
+        {
+            continue;
+        }
+        if(!this->readLine(line))
+        {
+            BOOST_LOG_SEV(lg, Error) << "Chain Config: Bad Line " << lineNum << " In " << fileName << ": " << line;
+            throw std::runtime_error("ChainConfig Error - Bad Filter Config Line");
+        }
+    }
+    BOOST_LOG_SEV(lg, Information) << "Chain Config: Read Filter Settings From: " << fileName;
+    return true;
+}
+
+bool ChainConfig::readLine(const std::string& line)
+{
+    std::istringstream fields(line);
+    std::string key;
+    long long first = 0;
+    long long second = 0;
+    std::string extra;
+    fields >> key;
+    if((key == "coincWindow") || (key == "vetoWindow"))
+    {
+        if(!(fields >> first) || (fields >> extra) || (first < 0))
+        {
+            return false;
+        }
+        if(key == "coincWindow")
+        {
+            coincWindow = static_cast<unsigned long long>(first);
+        }
+        else
+        {
+            vetoWindow = static_cast<unsigned long long>(first);
+        }
+        return true;
+    }
+    if(key == "group")
+    {
+        if(!(fields >> first >> second) || (fields >> extra) ||
+           (first < 0) || (first >= MaxFilterChannels) || (second < -1) || (second >= MaxCoincGroups))
+        {
+            return false;
+        }
+        channelGroup[first] = static_cast<int>(second);
+        return true;
+    }
+    if(key == "multiplicity")
+    {
+        if(!(fields >> first >> second) || (fields >> extra) ||
+           (first < 0) || (first >= MaxCoincGroups) || (second < 1) || (second > MaxFilterChannels))
+        {
+            return false;
+        }
+        groupMultiplicity[first] = static_cast<int>(second);
+        return true;
+    }
+    if((key == "vetoChannel") || (key == "vetoed"))
+    {
+        if(!(fields >> first) || (fields >> extra) || (first < 0) || (first >= MaxFilterChannels))
+        {
+            return false;
+        }
+        if(key == "vetoChannel")
+        {
+            isVetoChannel[first] = 1;
+        }
+        else
+        {
+            isVetoed[first] = 1;
+        }
+        return true;
+    }
+    if(key == "writeVetoChannels")
+    {
+        if(!(fields >> first) || (fields >> extra) || (first < 0) || (first > 1))
+        {
+            return false;
+        }
+        writeVetoChannels = (first == 1);
+        return true;
+    }
+    if((key == "prescale") || (key == "threshold"))
+    {
+        //the long charge is 16 bits, so a higher threshold would drop everything
+        long long limit = ((key == "prescale") ? 0x7FFFFFFFLL : 0xFFFFLL);
+        if(!(fields >> first >> second) || (fields >> extra) ||
+           (first < 0) || (first >= MaxReducerChannels) || (second < 0) || (second > limit) ||
+           ((key == "prescale") && (second < 1)))
+        {
+            return false;
+        }
+        if(key == "prescale")
+        {
+            prescale[first] = static_cast<int>(second);
+        }
+        else
+        {
+            chargeThreshold[first] = static_cast<int>(second);
+        }
+        return true;
+    }
+    if(key == "histOnly")
+    {
+        if(!(fields >> first) || (fields >> extra) || (first < 0) || (first >= MaxReducerChannels))
+        {
+            return false;
+        }
+        histOnly[first] = 1;
+        return true;
+    }
+    return false;
+}
+
+void ChainConfig::applyTo(CoincidenceFilter& filter) const
+{
+    filter.setCoincidenceWindow(coincWindow);
+    filter.setVetoWindow(vetoWindow);
+    for(int i=0; i<MaxFilterChannels; ++i)
+    {
+        filter.setChannelGroup(i, channelGroup[i]);
+        filter.setVetoChannel(i, (isVetoChannel[i] != 0));
+        filter.setChannelVetoed(i, (isVetoed[i] != 0));
+    }
+    for(int i=0; i<MaxCoincGroups; ++i)
+    {
+        filter.setGroupMultiplicity(i, groupMultiplicity[i]);
+    }
+    filter.setWriteVetoChannels(writeVetoChannels);
+}
+
+void ChainConfig::applyTo(ChannelReducer& reducer) const
+{
+    for(int i=0; i<MaxReducerChannels; ++i)
+    {
+        reducer.setPrescale(i, prescale[i]);
+        reducer.setChargeThreshold(i, chargeThreshold[i]);
+        reducer.setHistogramOnly(i, (histOnly[i] != 0));
+    }
+}
+
+void ChainConfig::logSettings()
+{
+    bool anyFilter = false;
+    for(int g=0; g<MaxCoincGroups; ++g)
+    {
+        std::ostringstream members;
+        int memberCount = 0;
+        for(int i=0; i<MaxFilterChannels; ++i)
+        {
+            if(channelGroup[i] == g)
+            {
+                members << " " << i;
+                ++memberCount;
+            }
+        }
+        if(memberCount == 0)
+        {
+            continue;
+        }
+        anyFilter = true;
+        BOOST_LOG_SEV(lg, Information) << "Chain Config: Coincidence Group " << g << " Needs " << groupMultiplicity[g] << " Hit(s) Within +/- " << coincWindow << " Ticks From Channel(s):" << members.str();
+        if(groupMultiplicity[g] < 2)
+        {
+            BOOST_LOG_SEV(lg, Warning) << "Chain Config: Coincidence Group " << g << " Has A Multiplicity Below 2, Its Channels Pass Unconditionally";
+        }
+    }
+    std::ostringstream vetoes;
+    std::ostringstream vetoedChans;
+    int vetoCount = 0;
+    int vetoedCount = 0;
+    for(int i=0; i<MaxFilterChannels; ++i)
+    {
+        if(isVetoChannel[i] != 0)
+        {
+            vetoes << " " << i;
+            ++vetoCount;
+        }
+        if(isVetoed[i] != 0)
+        {
+            vetoedChans << " " << i;
+            ++vetoedCount;
+        }
+    }
+    if(vetoCount > 0)
+    {
+        anyFilter = true;
+        BOOST_LOG_SEV(lg, Information) << "Chain Config: Veto Channel(s):" << vetoes.str() << " Vetoed Channel(s):" << vetoedChans.str() << " Within +/- " << vetoWindow << " Ticks, Veto Channels Are " << (writeVetoChannels ? "Written" : "Not Written");
+    }
+    if((vetoCount > 0) != (vetoedCount > 0))
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Chain Config: Vetoes Need Both Veto Channels And Vetoed Channels, Only One Was Given So Nothing Is Vetoed";
+    }
+    if(!anyFilter)
+    {
+        BOOST_LOG_SEV(lg, Information) << "Chain Config: No Coincidence Groups Or Vetoes Set, The Filter Passes Every Event";
+    }
+    bool anyReduced = false;
+    for(int i=0; i<MaxReducerChannels; ++i)
+    {
+        if(histOnly[i] != 0)
+        {
+            anyReduced = true;
+            BOOST_LOG_SEV(lg, Information) << "Chain Config: Channel " << i << " Is Histogram Only";
+        }
+        else if((prescale[i] != 1) || (chargeThreshold[i] != 0))
+        {
+            anyReduced = true;
+            BOOST_LOG_SEV(lg, Information) << "Chain Config: Channel " << i << " Writes 1 In " << prescale[i] << " Events With Long Charge At Or Above " << chargeThreshold[i];
+        }
+    }
+    if(!anyReduced)
+    {
+        BOOST_LOG_SEV(lg, Information) << "Chain Config: No Prescales, Thresholds Or Histogram Only Channels Set, The Reducer Passes Every Event";
+    }
+}
+
+}
@@ -0,0 +1,87 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ChainConfig.h
+** @author James Till Matta
+** @date 20 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the ChainConfig class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_FILTER_CHAINCONFIG_H
+#define ORCHID_SRC_FILTER_CHAINCONFIG_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+// includes from other libraries
+// includes from ORCHID
+#include"ChannelReducer.h"
+#include"CoincidenceFilter.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Filter
+{
+
+//Holds the settings for the filter and reducer stages of the acquire chain,
+//  read from a text file with one setting per line, blank lines and lines
+//  starting with # are skipped:
+//      coincWindow <ticks>
+//      vetoWindow <ticks>
+//      group <channel> <group 0-15>
+//      multiplicity <group 0-15> <hits needed>
+//      vetoChannel <channel>
+//      vetoed <channel>
+//      writeVetoChannels <0|1>
+//      prescale <channel> <keep one in N>
+//      threshold <channel> <long charge>
+//      histOnly <channel>
+//  channels are global channel numbers (16 * module number + board channel)
+//  as the stages see them
+//The settings are kept rather than set straight into a stage so that whoever
+//  builds the chain can apply them to it, a file that sets nothing leaves the
+//  filter and reducer passing every event
+class ChainConfig
+{
+public:
+    ChainConfig();
+    ~ChainConfig(){}
+
+    //throws on a bad line, if the file cannot be opened it throws when
+    //mustExist is set and otherwise logs that the defaults are in use and
+    //returns false
+    bool readFile(const std::string& fileName, bool mustExist);
+
+    void applyTo(CoincidenceFilter& filter) const;
+    void applyTo(ChannelReducer& reducer) const;
+    //writes what the chain will do to the log, once at startup
+    void logSettings();
+
+private:
+    //false if the line is malformed or a number is out of range
+    bool readLine(const std::string& line);
+
+    unsigned long long coincWindow;
+    unsigned long long vetoWindow;
+    int channelGroup[MaxFilterChannels];    //-1 for no group
+    int isVetoChannel[MaxFilterChannels];
+    int isVetoed[MaxFilterChannels];
+    int groupMultiplicity[MaxCoincGroups];
+    bool writeVetoChannels;
+    int prescale[MaxReducerChannels];
+    int chargeThreshold[MaxReducerChannels];
+    int histOnly[MaxReducerChannels];
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_FILTER_CHAINCONFIG_H
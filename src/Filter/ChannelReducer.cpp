@@ -0,0 +1,80 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ChannelReducer.cpp
+** @author James Till Matta
+** @date 07 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the ChannelReducer class
+**
+********************************************************************************
+*******************************************************************************/
+#include"ChannelReducer.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+
+namespace Filter
+{
+
+ChannelReducer::ChannelReducer(Events::EventSink* nextStage) :
+    next(nextStage), eventsPassed(0), lg(OrchidLog::get())
+{
+    //by default every event goes through
+    for(int i=0; i<MaxReducerChannels; ++i)
+    {
+        prescale[i] = 1;
+        prescaleCount[i] = 0;
+        chargeThreshold[i] = 0;
+        writeEnabled[i] = 1;
+    }
+}
+
+void ChannelReducer::setPrescale(int channel, int keepOneIn)
+{
+    this->checkChannel(channel);
+    if(keepOneIn < 1)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Filter: Invalid Prescale: " << keepOneIn << " For Channel: " << channel;
+        throw std::runtime_error("ChannelReducer Error - Invalid Prescale");
+    }
+    prescale[channel] = keepOneIn;
+    prescaleCount[channel] = 0;
+}
+
+void ChannelReducer::setChargeThreshold(int channel, int longChargeThreshold)
+{
+    this->checkChannel(channel);
+    chargeThreshold[channel] = longChargeThreshold;
+}
+
+void ChannelReducer::setHistogramOnly(int channel, bool histOnly)
+{
+    this->checkChannel(channel);
+    writeEnabled[channel] = (histOnly ? 0 : 1);
+}
+
+void ChannelReducer::flush()
+{
+    next->flush();
+}
+
+void ChannelReducer::checkChannel(int channel)
+{
+    if((channel < 0) || (channel >= MaxReducerChannels))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Filter: Invalid Channel Number: " << channel;
+        throw std::runtime_error("ChannelReducer Error - Invalid Channel Number");
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ChannelReducer.h
+** @author James Till Matta
+** @date 07 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the ChannelReducer class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_FILTER_CHANNELREDUCER_H
+#define ORCHID_SRC_FILTER_CHANNELREDUCER_H
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+#include"Events/EventSink.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Filter
+{
+
+enum {MaxReducerChannels = 256};
+
+//Per channel data reduction stage, sits after the coincidence filter and only
+//  decides what is written, the spectra are filled by the tap ahead of the
+//  filter so they see every event
+//An event is only handed to the next stage if its long charge is at or above
+//  the channel threshold, it is the Nth such event for a prescale of N, and
+//  the channel is not in histogram only mode
+//The configuration is in flat arrays indexed by global channel number
+//  (channelStartInd + channel) so the per event work is a few loads and
+//  compares with a single branch on the final decision
+class ChannelReducer : public Events::EventSink
+{
+public:
+    ChannelReducer(Events::EventSink* nextStage);
+    ~ChannelReducer(){}
+
+    //configuration, must be done before events start to flow
+    void setPrescale(int channel, int keepOneIn);
+    void setChargeThreshold(int channel, int longChargeThreshold);
+    void setHistogramOnly(int channel, bool histOnly);
+
+    void acceptEvent(const Events::DppPsdEvent& event) override
+    {
+        int chan = event.channel;
+        int above = (event.longCharge >= chargeThreshold[chan]);
+        int count = prescaleCount[chan] + above;
+        int fire = (count >= prescale[chan]);
+        prescaleCount[chan] = (fire ? 0 : count);
+        int keep = (above & fire & writeEnabled[chan]);
+        eventsPassed += static_cast<unsigned long long>(keep);
+        if(keep)
+        {
+            next->acceptEvent(event);
+        }
+    }
+    void flush() override;
+
+    unsigned long long getEventsPassed(){return eventsPassed;}
+
+private:
+    void checkChannel(int channel);
+
+    Events::EventSink* next;
+
+    //per channel configuration and state, indexed by global channel number
+    int prescale[MaxReducerChannels];
+    int prescaleCount[MaxReducerChannels];
+    int chargeThreshold[MaxReducerChannels];
+    int writeEnabled[MaxReducerChannels];
+
+    unsigned long long eventsPassed;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_FILTER_CHANNELREDUCER_H
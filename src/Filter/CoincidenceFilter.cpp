@@ -0,0 +1,247 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file CoincidenceFilter.cpp
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the CoincidenceFilter class
+**
+********************************************************************************
+*******************************************************************************/
+#include"CoincidenceFilter.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+#include"Metrics/MetricsRegistry.h"
+
+namespace Filter
+{
+
+//internally group slot 0 is "no group" with a multiplicity of zero so that the
+//ungrouped channels pass the coincidence test without a special case
+CoincidenceFilter::CoincidenceFilter(Events::EventSink* nextStage, int bufferSize) :
+    next(nextStage), buffer(static_cast<std::size_t>(bufferSize)), coincWindow(0),
+    vetoWindow(0), maxWindow(0), vetoCount(0), writeVetoChannels(false),
+    newestTime(0), firstSeq(0), nextSeq(0), decideSeq(0), coincLo(0), coincHi(0),
+    vetoLo(0), vetoHi(0), eventsSeen(0), eventsAccepted(0), forcedDecisions(0),
+    lateEvents(0), occupancyMetric(nullptr), forcedMetric(nullptr),
+    lateMetric(nullptr), lg(OrchidLog::get())
+{
+    Metrics::MetricsRegistry& registry = Metrics::MetricsRegistry::get();
+    occupancyMetric = registry.addGauge("orchid_coincidence_buffer_events", "Events held in the coincidence filter ring", "");
+    forcedMetric = registry.addCounter("orchid_coincidence_forced_decisions_total", "Events decided early because the coincidence ring was full", "");
+    lateMetric = registry.addCounter("orchid_coincidence_late_events_total", "Events dropped because they arrived older than an event already buffered", "");
+    for(int i=0; i<MaxFilterChannels; ++i)
+    {
+        channelGroup[i] = 0;
+        isVetoChannel[i] = 0;
+        isVetoed[i] = 0;
+    }
+    for(int i=0; i<(MaxCoincGroups+1); ++i)
+    {
+        groupMultiplicity[i] = 0;
+        groupCount[i] = 0;
+    }
+}
+
+CoincidenceFilter::~CoincidenceFilter()
+{
+    if(forcedDecisions > 0)
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Filter: " << forcedDecisions << " Events Were Decided Before Their Window Closed, Increase The Filter Buffer Size";
+    }
+    if(lateEvents > 0)
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Filter: " << lateEvents << " Events Reached The Coincidence Filter Out Of Order And Were Dropped, Increase The Sorter Reorder Window Or Buffer Size";
+    }
+}
+
+void CoincidenceFilter::setCoincidenceWindow(unsigned long long ticks)
+{
+    coincWindow = ticks;
+    maxWindow = ((coincWindow > vetoWindow) ? coincWindow : vetoWindow);
+}
+
+void CoincidenceFilter::setVetoWindow(unsigned long long ticks)
+{
+    vetoWindow = ticks;
+    maxWindow = ((coincWindow > vetoWindow) ? coincWindow : vetoWindow);
+}
+
+void CoincidenceFilter::setChannelGroup(int channel, int group)
+{
+    this->checkChannel(channel);
+    if((group < -1) || (group >= MaxCoincGroups))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Filter: Invalid Coincidence Group: " << group;
+        throw std::runtime_error("CoincidenceFilter Error - Invalid Coincidence Group");
+    }
+    channelGroup[channel] = (group + 1);
+}
+
+void CoincidenceFilter::setGroupMultiplicity(int group, int multiplicity)
+{
+    if((group < 0) || (group >= MaxCoincGroups))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Filter: Invalid Coincidence Group: " << group;
+        throw std::runtime_error("CoincidenceFilter Error - Invalid Coincidence Group");
+    }
+    groupMultiplicity[group + 1] = multiplicity;
+}
+
+void CoincidenceFilter::setVetoChannel(int channel, bool isVeto)
+{
+    this->checkChannel(channel);
+    isVetoChannel[channel] = (isVeto ? 1 : 0);
+}
+
+void CoincidenceFilter::setChannelVetoed(int channel, bool vetoed)
+{
+    this->checkChannel(channel);
+    isVetoed[channel] = (vetoed ? 1 : 0);
+}
+
+void CoincidenceFilter::checkChannel(int channel)
+{
+    if((channel < 0) || (channel >= MaxFilterChannels))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Filter: Invalid Channel Number: " << channel;
+        throw std::runtime_error("CoincidenceFilter Error - Invalid Channel Number");
+    }
+}
+
+void CoincidenceFilter::acceptEvent(const Events::DppPsdEvent& event)
+{
+    ++eventsSeen;
+    //the window edges cannot move back, so an out of order event is dropped
+    //before it touches the buffer or the counts
+    if(event.timeStamp < newestTime)
+    {
+        ++lateEvents;
+        lateMetric->add(1);
+        return;
+    }
+    newestTime = event.timeStamp;
+    //everything whose widest window closes before this event can be decided
+    while((decideSeq < nextSeq) && ((eventAt(decideSeq).timeStamp + maxWindow) < event.timeStamp))
+    {
+        this->decideNextEvent();
+    }
+    this->trimBuffer();
+    if(buffer.full())
+    {
+        this->dropOldestEvent();
+    }
+    buffer.push_back(event);
+    ++nextSeq;
+    occupancyMetric->set(static_cast<double>(buffer.size()));
+}
+
+void CoincidenceFilter::flush()
+{
+    while(decideSeq < nextSeq)
+    {
+        this->decideNextEvent();
+    }
+    //nothing is left pending so throw away the window state
+    buffer.clear();
+    newestTime = 0;
+    firstSeq = nextSeq;
+    coincLo = nextSeq;
+    coincHi = nextSeq;
+    vetoLo = nextSeq;
+    vetoHi = nextSeq;
+    vetoCount = 0;
+    for(int i=0; i<(MaxCoincGroups+1); ++i)
+    {
+        groupCount[i] = 0;
+    }
+    next->flush();
+}
+
+void CoincidenceFilter::decideNextEvent()
+{
+    const Events::DppPsdEvent& event = eventAt(decideSeq);
+    unsigned long long evTime = event.timeStamp;
+    //slide the leading edges of the windows forward
+    while((coincHi < nextSeq) && (eventAt(coincHi).timeStamp <= (evTime + coincWindow)))
+    {
+        ++groupCount[channelGroup[eventAt(coincHi).channel]];
+        ++coincHi;
+    }
+    while((vetoHi < nextSeq) && (eventAt(vetoHi).timeStamp <= (evTime + vetoWindow)))
+    {
+        vetoCount += isVetoChannel[eventAt(vetoHi).channel];
+        ++vetoHi;
+    }
+    //slide the trailing edges of the windows forward, the event being decided
+    //is always inside both windows so these can never pass the leading edges
+    while((eventAt(coincLo).timeStamp + coincWindow) < evTime)
+    {
+        --groupCount[channelGroup[eventAt(coincLo).channel]];
+        ++coincLo;
+    }
+    while((eventAt(vetoLo).timeStamp + vetoWindow) < evTime)
+    {
+        vetoCount -= isVetoChannel[eventAt(vetoLo).channel];
+        ++vetoLo;
+    }
+
+    int chan = event.channel;
+    int grp = channelGroup[chan];
+    bool coincPass = (groupCount[grp] >= groupMultiplicity[grp]);
+    //a veto channel does not veto itself
+    bool vetoPass = ((isVetoed[chan] == 0) || ((vetoCount - isVetoChannel[chan]) == 0));
+    bool writePass = (writeVetoChannels || (isVetoChannel[chan] == 0));
+    if(coincPass && vetoPass && writePass)
+    {
+        next->acceptEvent(event);
+        ++eventsAccepted;
+    }
+    ++decideSeq;
+}
+
+void CoincidenceFilter::dropOldestEvent()
+{
+    //the buffer is too short for the windows, decide the oldest event with
+    //what we have rather than stalling the readout
+    if(decideSeq == firstSeq)
+    {
+        this->decideNextEvent();
+        ++forcedDecisions;
+        forcedMetric->add(1);
+    }
+    if(coincLo == firstSeq)
+    {
+        --groupCount[channelGroup[eventAt(coincLo).channel]];
+        ++coincLo;
+    }
+    if(vetoLo == firstSeq)
+    {
+        vetoCount -= isVetoChannel[eventAt(vetoLo).channel];
+        ++vetoLo;
+    }
+    buffer.pop_front();
+    ++firstSeq;
+}
+
+void CoincidenceFilter::trimBuffer()
+{
+    while((firstSeq < decideSeq) && (firstSeq < coincLo) && (firstSeq < vetoLo))
+    {
+        buffer.pop_front();
+        ++firstSeq;
+    }
+}
+
+}
@@ -0,0 +1,123 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file CoincidenceFilter.h
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the CoincidenceFilter class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_FILTER_COINCIDENCEFILTER_H
+#define ORCHID_SRC_FILTER_COINCIDENCEFILTER_H
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+#include<boost/circular_buffer.hpp>
+// includes from ORCHID
+#include"Events/EventSink.h"
+#include"Metrics/Metric.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Filter
+{
+
+enum {MaxFilterChannels = 256, MaxCoincGroups = 16, DefaultCoincBufferSize = 65536};
+
+//Software coincidence / anti-coincidence stage, sits after time ordering
+//Each channel can be put in a group, an event in a grouped channel is only
+//  passed on if at least the group multiplicity of hits (itself included) from
+//  that group lie within +/- the coincidence window of it
+//Channels flagged as vetoed are dropped if any veto channel fired within
+//  +/- the veto window of them
+//Events are held until the newest event is past the widest window, then
+//  decided, the hit counts are kept with two pointers per window into the
+//  buffer so every event is added to and removed from each count exactly once
+//The pointers only move forward so the input must be in time order, an event
+//  older than the newest one already buffered (the sorter released it late or
+//  early) cannot be placed in the windows and is dropped and counted
+class CoincidenceFilter : public Events::EventSink
+{
+public:
+    CoincidenceFilter(Events::EventSink* nextStage, int bufferSize);
+    ~CoincidenceFilter();
+
+    //configuration, must be done before events start to flow
+    void setCoincidenceWindow(unsigned long long ticks);
+    void setVetoWindow(unsigned long long ticks);
+    void setChannelGroup(int channel, int group);
+    void setGroupMultiplicity(int group, int multiplicity);
+    void setVetoChannel(int channel, bool isVeto);
+    void setChannelVetoed(int channel, bool vetoed);
+    void setWriteVetoChannels(bool write){writeVetoChannels = write;}
+
+    void acceptEvent(const Events::DppPsdEvent& event) override;
+    void flush() override;
+
+    unsigned long long getEventsSeen(){return eventsSeen;}
+    unsigned long long getEventsAccepted(){return eventsAccepted;}
+    unsigned long long getForcedDecisions(){return forcedDecisions;}
+    unsigned long long getLateEvents(){return lateEvents;}
+    int getBufferOccupancy(){return static_cast<int>(buffer.size());}
+
+private:
+    void checkChannel(int channel);
+    void decideNextEvent();
+    void dropOldestEvent();
+    void trimBuffer();
+    const Events::DppPsdEvent& eventAt(unsigned long long seq)
+    {return buffer[static_cast<std::size_t>(seq - firstSeq)];}
+
+    Events::EventSink* next;
+    boost::circular_buffer<Events::DppPsdEvent> buffer;
+
+    //window sizes in clock ticks
+    unsigned long long coincWindow;
+    unsigned long long vetoWindow;
+    unsigned long long maxWindow;
+
+    //per channel configuration, indexed by global channel number
+    int channelGroup[MaxFilterChannels];
+    int isVetoChannel[MaxFilterChannels];
+    int isVetoed[MaxFilterChannels];
+    //per group configuration and the running hit counts
+    int groupMultiplicity[MaxCoincGroups+1];
+    int groupCount[MaxCoincGroups+1];
+    int vetoCount;
+    bool writeVetoChannels;
+    //time stamp of the newest event pushed into the buffer
+    unsigned long long newestTime;
+
+    //sequence numbers (total count of events pushed) of the buffer front, the
+    //next event to push, the next event to decide, and the edges of the
+    //coincidence and veto windows [lo, hi) whose contents are in the counts
+    unsigned long long firstSeq;
+    unsigned long long nextSeq;
+    unsigned long long decideSeq;
+    unsigned long long coincLo;
+    unsigned long long coincHi;
+    unsigned long long vetoLo;
+    unsigned long long vetoHi;
+
+    unsigned long long eventsSeen;
+    unsigned long long eventsAccepted;
+    unsigned long long forcedDecisions;
+    unsigned long long lateEvents;
+    Metrics::MetricGauge* occupancyMetric;
+    Metrics::MetricCounter* forcedMetric;
+    Metrics::MetricCounter* lateMetric;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_FILTER_COINCIDENCEFILTER_H
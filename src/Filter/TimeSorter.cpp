@@ -0,0 +1,115 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file TimeSorter.cpp
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the TimeSorter class
+**
+********************************************************************************
+*******************************************************************************/
+#include"TimeSorter.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<algorithm>
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+#include"Metrics/MetricsRegistry.h"
+
+namespace Filter
+{
+
+//heap ordering that puts the earliest time stamp at the front
+static bool laterThan(const Events::DppPsdEvent& lhs, const Events::DppPsdEvent& rhs)
+{
+    return (lhs.timeStamp > rhs.timeStamp);
+}
+
+TimeSorter::TimeSorter(Events::EventSink* nextStage, int bufferSize, unsigned long long reorderWindow) :
+    next(nextStage), heap(), capacity(0), window(reorderWindow), newestTime(0),
+    lastReleasedTime(0), eventsSorted(0), lateEvents(0), forcedReleases(0),
+    occupancyMetric(nullptr), lateMetric(nullptr), lg(OrchidLog::get())
+{
+    if(bufferSize < 1)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Filter: Invalid Sorter Buffer Size: " << bufferSize;
+        throw std::runtime_error("TimeSorter Error - Invalid Buffer Size");
+    }
+    capacity = static_cast<std::size_t>(bufferSize);
+    heap.reserve(capacity);
+    Metrics::MetricsRegistry& registry = Metrics::MetricsRegistry::get();
+    occupancyMetric = registry.addGauge("orchid_sorter_buffer_events", "Events held in the time ordering heap", "");
+    lateMetric = registry.addCounter("orchid_sorter_late_events_total", "Events that arrived after a later event had already been released", "");
+}
+
+TimeSorter::~TimeSorter()
+{
+    if(lateEvents > 0)
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Filter: " << lateEvents << " Events Left The Sorter Out Of Order, Increase The Reorder Window Or Buffer Size";
+    }
+    if(forcedReleases > 0)
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Filter: " << forcedReleases << " Events Were Released Early Because The Sorter Heap Was Full, Increase The Sorter Buffer Size";
+    }
+}
+
+void TimeSorter::acceptEvent(const Events::DppPsdEvent& event)
+{
+    ++eventsSorted;
+    if(event.timeStamp > newestTime)
+    {
+        newestTime = event.timeStamp;
+    }
+    //release everything that can no longer be preceded by an incoming event
+    while(!heap.empty() && ((heap.front().timeStamp + window) < newestTime))
+    {
+        this->releaseOldest();
+    }
+    if(heap.size() == capacity)
+    {
+        ++forcedReleases;
+        this->releaseOldest();
+    }
+    heap.push_back(event);
+    std::push_heap(heap.begin(), heap.end(), laterThan);
+    occupancyMetric->set(static_cast<double>(heap.size()));
+}
+
+void TimeSorter::flush()
+{
+    while(!heap.empty())
+    {
+        this->releaseOldest();
+    }
+    occupancyMetric->set(0.0);
+    next->flush();
+}
+
+void TimeSorter::releaseOldest()
+{
+    std::pop_heap(heap.begin(), heap.end(), laterThan);
+    const Events::DppPsdEvent& event = heap.back();
+    if(event.timeStamp < lastReleasedTime)
+    {
+        ++lateEvents;
+        lateMetric->add(1);
+    }
+    else
+    {
+        lastReleasedTime = event.timeStamp;
+    }
+    next->acceptEvent(event);
+    heap.pop_back();
+}
+
+}
@@ -0,0 +1,79 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file TimeSorter.h
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the TimeSorter class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_FILTER_TIMESORTER_H
+#define ORCHID_SRC_FILTER_TIMESORTER_H
+// includes for C system headers
+// includes for C++ system headers
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Events/EventSink.h"
+#include"Metrics/Metric.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Filter
+{
+
+//room for a million events and a reorder window of 100 ms of 2 ns ticks
+enum {DefaultSortBufferSize = 1048576, DefaultSortWindow = 50000000};
+
+//Time ordering (merge) stage, sits between the parser and the coincidence filter
+//The parser emits each channel couple's events in order, but a readout
+//  interleaves the couples and the boards, so events are held in a min heap
+//  on their time stamp and released once the newest time stamp seen is more
+//  than the reorder window past them
+//The heap storage is reserved at construction so steady state running does
+//  not allocate, if the heap fills the oldest event is released early
+class TimeSorter : public Events::EventSink
+{
+public:
+    TimeSorter(Events::EventSink* nextStage, int bufferSize, unsigned long long reorderWindow);
+    ~TimeSorter();
+
+    void acceptEvent(const Events::DppPsdEvent& event) override;
+    void flush() override;
+
+    unsigned long long getEventsSorted(){return eventsSorted;}
+    unsigned long long getLateEvents(){return lateEvents;}
+    unsigned long long getForcedReleases(){return forcedReleases;}
+    int getBufferOccupancy(){return static_cast<int>(heap.size());}
+
+private:
+    void releaseOldest();
+
+    Events::EventSink* next;
+    std::vector<Events::DppPsdEvent> heap;
+    std::size_t capacity;
+    //window size in clock ticks
+    unsigned long long window;
+    unsigned long long newestTime;
+    unsigned long long lastReleasedTime;
+
+    unsigned long long eventsSorted;
+    unsigned long long lateEvents;
+    unsigned long long forcedReleases;
+    Metrics::MetricGauge* occupancyMetric;
+    Metrics::MetricCounter* lateMetric;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_FILTER_TIMESORTER_H
@@ -0,0 +1,113 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file Metric.h
+** @author James Till Matta
+** @date 27 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Holds the counter and gauge types that the hot paths update and
+** the metrics endpoint reads
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_METRICS_METRIC_H
+#define ORCHID_SRC_METRICS_METRIC_H
+
+// includes for C system headers
+// includes for C++ system headers
+#include<atomic>
+// includes from other libraries
+// includes from ORCHID
+
+namespace Metrics
+{
+
+//the last slot is shared by any threads beyond the first MaxMetricThreads - 1
+enum {MaxMetricThreads = 16, SharedMetricSlot = (MaxMetricThreads - 1), MetricCacheLine = 64};
+
+//gives each thread its own slot in every counter the first time it touches one
+inline int metricThreadSlot()
+{
+    static std::atomic<int> nextSlot(0);
+    thread_local int slot = -1;
+    if(slot < 0)
+    {
+        int taken = nextSlot.fetch_add(1, std::memory_order_relaxed);
+        slot = ((taken < SharedMetricSlot) ? taken : SharedMetricSlot);
+    }
+    return slot;
+}
+
+//Monotonic counter split into one cache line per thread, a thread with its
+//  own slot only ever does a relaxed load and store on a line nobody else
+//  writes, so there is no locked instruction and no line bouncing between the
+//  readout and processing cores, the scrape sums the slots
+class MetricCounter
+{
+public:
+    MetricCounter()
+    {
+        for(int i=0; i<MaxMetricThreads; ++i)
+        {
+            slots[i].value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(unsigned long long amount)
+    {
+        int slot = metricThreadSlot();
+        if(slot != SharedMetricSlot)
+        {
+            slots[slot].value.store(slots[slot].value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+        else
+        {
+            slots[slot].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    unsigned long long total() const
+    {
+        unsigned long long sum = 0;
+        for(int i=0; i<MaxMetricThreads; ++i)
+        {
+            sum += slots[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    //padded out to a line rather than aligned, C++14 new ignores over alignment
+    struct Slot
+    {
+        std::atomic<unsigned long long> value;
+        char pad[MetricCacheLine - sizeof(std::atomic<unsigned long long>)];
+    };
+    Slot slots[MaxMetricThreads];
+};
+
+//Point in time value, the owner overwrites it and the scrape reads whatever
+//  was last stored
+class MetricGauge
+{
+public:
+    MetricGauge() : value(0.0), pad(){}
+
+    void set(double newValue){value.store(newValue, std::memory_order_relaxed);}
+    double get() const {return value.load(std::memory_order_relaxed);}
+
+private:
+    std::atomic<double> value;
+    char pad[MetricCacheLine - sizeof(std::atomic<double>)];
+};
+
+}
+
+#endif //ORCHID_SRC_METRICS_METRIC_H
@@ -0,0 +1,135 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file MetricsRegistry.cpp
+** @author James Till Matta
+** @date 27 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the MetricsRegistry class
+**
+********************************************************************************
+*******************************************************************************/
+#include"MetricsRegistry.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<sstream>
+// includes from other libraries
+// includes from ORCHID
+
+namespace Metrics
+{
+
+MetricsRegistry& MetricsRegistry::get()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::MetricsRegistry() : registryMutex(), entries()
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    for(std::size_t i=0; i<entries.size(); ++i)
+    {
+        delete entries[i].counter;
+        delete entries[i].gauge;
+    }
+}
+
+MetricCounter* MetricsRegistry::addCounter(const std::string& name, const std::string& help, const std::string& labels)
+{
+    boost::lock_guard<boost::mutex> lock(registryMutex);
+    Entry* existing = this->findEntry(name, labels);
+    if((existing != nullptr) && (existing->counter != nullptr))
+    {
+        return existing->counter;
+    }
+    Entry entry;
+    entry.name = name;
+    entry.help = help;
+    entry.labels = labels;
+    entry.counter = new MetricCounter();
+    entry.gauge = nullptr;
+    entries.push_back(entry);
+    return entry.counter;
+}
+
+MetricGauge* MetricsRegistry::addGauge(const std::string& name, const std::string& help, const std::string& labels)
+{
+    boost::lock_guard<boost::mutex> lock(registryMutex);
+    Entry* existing = this->findEntry(name, labels);
+    if((existing != nullptr) && (existing->gauge != nullptr))
+    {
+        return existing->gauge;
+    }
+    Entry entry;
+    entry.name = name;
+    entry.help = help;
+    entry.labels = labels;
+    entry.counter = nullptr;
+    entry.gauge = new MetricGauge();
+    entries.push_back(entry);
+    return entry.gauge;
+}
+
+std::string MetricsRegistry::render()
+{
+    boost::lock_guard<boost::mutex> lock(registryMutex);
+    std::ostringstream text;
+    //the format wants all the samples of a name together under one header
+    std::vector<bool> written(entries.size(), false);
+    for(std::size_t i=0; i<entries.size(); ++i)
+    {
+        if(written[i])
+        {
+            continue;
+        }
+        text << "# HELP " << entries[i].name << " " << entries[i].help << "\n";
+        text << "# TYPE " << entries[i].name << ((entries[i].counter != nullptr) ? " counter\n" : " gauge\n");
+        for(std::size_t j=i; j<entries.size(); ++j)
+        {
+            if(written[j] || (entries[j].name != entries[i].name))
+            {
+                continue;
+            }
+            written[j] = true;
+            text << entries[j].name;
+            if(!entries[j].labels.empty())
+            {
+                text << "{" << entries[j].labels << "}";
+            }
+            if(entries[j].counter != nullptr)
+            {
+                text << " " << entries[j].counter->total() << "\n";
+            }
+            else
+            {
+                text << " " << entries[j].gauge->get() << "\n";
+            }
+        }
+    }
+    return text.str();
+}
+
+MetricsRegistry::Entry* MetricsRegistry::findEntry(const std::string& name, const std::string& labels)
+{
+    for(std::size_t i=0; i<entries.size(); ++i)
+    {
+        if((entries[i].name == name) && (entries[i].labels == labels))
+        {
+            return &(entries[i]);
+        }
+    }
+    return nullptr;
+}
+
+}
@@ -0,0 +1,70 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file MetricsRegistry.h
+** @author James Till Matta
+** @date 27 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the MetricsRegistry class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_METRICS_METRICSREGISTRY_H
+#define ORCHID_SRC_METRICS_METRICSREGISTRY_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<vector>
+// includes from other libraries
+#include<boost/thread.hpp>
+// includes from ORCHID
+#include"Metric.h"
+
+namespace Metrics
+{
+
+//Process wide list of every counter and gauge, the objects doing the work ask
+//  for their metrics once when they are built and keep the pointers, only the
+//  registration and the scrape take the lock
+//Asking again for a name and label set that already exists hands back the
+//  same metric, so objects that get rebuilt keep counting into it
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry& get();
+    ~MetricsRegistry();
+
+    //labels are in Prometheus form without the braces, e.g. board="0"
+    MetricCounter* addCounter(const std::string& name, const std::string& help, const std::string& labels);
+    MetricGauge* addGauge(const std::string& name, const std::string& help, const std::string& labels);
+
+    //the current value of everything in the Prometheus text format
+    std::string render();
+
+private:
+    MetricsRegistry();
+
+    struct Entry
+    {
+        std::string name;
+        std::string help;
+        std::string labels;
+        MetricCounter* counter;
+        MetricGauge* gauge;
+    };
+    Entry* findEntry(const std::string& name, const std::string& labels);
+
+    boost::mutex registryMutex;
+    std::vector<Entry> entries;
+};
+
+}
+
+#endif //ORCHID_SRC_METRICS_METRICSREGISTRY_H
@@ -0,0 +1,155 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file MetricsServer.cpp
+** @author James Till Matta
+** @date 27 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the MetricsServer class
+**
+********************************************************************************
+*******************************************************************************/
+#include"MetricsServer.h"
+// includes for C system headers
+#include<sys/types.h>
+#include<sys/socket.h>
+#include<netinet/in.h>
+#include<arpa/inet.h>
+#include<poll.h>
+#include<unistd.h>
+// includes for C++ system headers
+#include<sstream>
+#include<stdexcept>
+#include<string>
+// includes from other libraries
+// includes from ORCHID
+#include"MetricsRegistry.h"
+#include"Utility/ThreadPlacement.h"
+
+namespace Metrics
+{
+
+enum {PollTimeoutMs = 200, RequestChunkSize = 1024, ListenBacklog = 4};
+
+MetricsServer::MetricsServer(int portNum) :
+    port(portNum), listenSocket(-1), running(false), cpu(-1), serveThread(nullptr),
+    lg(OrchidLog::get())
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    this->stop();
+}
+
+void MetricsServer::start()
+{
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if(listenSocket < 0)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Metrics: Could Not Create Socket";
+        throw std::runtime_error("MetricsServer Error - Could Not Create Socket");
+    }
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<unsigned short>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if((bind(listenSocket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) ||
+       (listen(listenSocket, ListenBacklog) != 0))
+    {
+        close(listenSocket);
+        listenSocket = -1;
+        BOOST_LOG_SEV(lg, Error) << "Metrics: Could Not Listen On 127.0.0.1:" << port;
+        throw std::runtime_error("MetricsServer Error - Could Not Listen");
+    }
+    running.store(true);
+    serveThread = new boost::thread(&MetricsServer::serveLoop, this);
+    BOOST_LOG_SEV(lg, Information) << "Metrics: Serving On http://127.0.0.1:" << port << "/metrics";
+}
+
+void MetricsServer::stop()
+{
+    if(serveThread != nullptr)
+    {
+        running.store(false);
+        serveThread->join();
+        delete serveThread;
+        serveThread = nullptr;
+    }
+    if(listenSocket >= 0)
+    {
+        close(listenSocket);
+        listenSocket = -1;
+    }
+}
+
+void MetricsServer::serveLoop()
+{
+    Utility::ThreadPlacement::pinCallingThread(cpu);
+    while(running.load())
+    {
+        struct pollfd pfd;
+        pfd.fd = listenSocket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if(poll(&pfd, 1, PollTimeoutMs) <= 0)
+        {
+            continue;
+        }
+        int connection = accept(listenSocket, nullptr, nullptr);
+        if(connection < 0)
+        {
+            continue;
+        }
+        this->answerRequest(connection);
+        close(connection);
+    }
+}
+
+void MetricsServer::answerRequest(int connection)
+{
+    //whatever was asked for, the only thing we serve is the metrics, so just
+    //wait for the request to show up and throw it away
+    struct pollfd pfd;
+    pfd.fd = connection;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if(poll(&pfd, 1, PollTimeoutMs) <= 0)
+    {
+        return;
+    }
+    char request[RequestChunkSize];
+    if(recv(connection, request, RequestChunkSize, 0) <= 0)
+    {
+        return;
+    }
+    std::string body = MetricsRegistry::get().render();
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string text = response.str();
+    std::size_t sent = 0;
+    while(sent < text.size())
+    {
+        ssize_t count = send(connection, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if(count <= 0)
+        {
+            return;
+        }
+        sent += static_cast<std::size_t>(count);
+    }
+}
+
+}
@@ -0,0 +1,62 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file MetricsServer.h
+** @author James Till Matta
+** @date 27 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the MetricsServer class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_METRICS_METRICSSERVER_H
+#define ORCHID_SRC_METRICS_METRICSSERVER_H
+// includes for C system headers
+// includes for C++ system headers
+#include<atomic>
+// includes from other libraries
+#include<boost/thread.hpp>
+// includes from ORCHID
+#include"Utility/OrchidLogger.h"
+
+namespace Metrics
+{
+
+//Minimal HTTP server bound to the loopback interface that answers every
+//  request with the registry contents in the Prometheus text format, it runs
+//  on its own thread and only reads the metrics so it never touches the
+//  threads doing the work
+class MetricsServer
+{
+public:
+    MetricsServer(int portNum);
+    ~MetricsServer();
+
+    //the cpu the serving thread pins itself to, -1 (the default) for any
+    void setCpu(int cpuNum){cpu = cpuNum;}
+    void start();
+    void stop();
+
+private:
+    void serveLoop();
+    void answerRequest(int connection);
+
+    int port;
+    int listenSocket;
+    std::atomic<bool> running;
+    int cpu;
+    boost::thread* serveThread;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_METRICS_METRICSSERVER_H
@@ -0,0 +1,113 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file EventFileWriter.cpp
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the EventFileWriter class
+**
+********************************************************************************
+*******************************************************************************/
+#include"EventFileWriter.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<cstring>
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+#include"Metrics/MetricsRegistry.h"
+#include"Utility/ThreadPlacement.h"
+
+namespace Output
+{
+
+enum {WriteBufferSize = (4*1024*1024)};
+
+EventFileWriter::EventFileWriter(const std::string& fileName) :
+    outFile(), buffer(nullptr), bufferSize(WriteBufferSize), bufferFill(0),
+    eventsWritten(0), bytesWritten(0), bytesWrittenMetric(nullptr), lg(OrchidLog::get())
+{
+    outFile.open(fileName.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if(!outFile.is_open())
+    {
+        BOOST_LOG_SEV(lg, Error) << "Output: Could Not Open Event File: " << fileName;
+        throw std::runtime_error("EventFileWriter Error - Could Not Open Output File");
+    }
+    //paged in up front so the first trips through the buffer do not fault
+    buffer = Utility::ThreadPlacement::allocateLocalBuffer(static_cast<std::size_t>(bufferSize));
+    //rate() of this is the write bandwidth
+    bytesWrittenMetric = Metrics::MetricsRegistry::get().addCounter("orchid_output_bytes_written_total", "Bytes written to the event file", "");
+    BOOST_LOG_SEV(lg, Information) << "Output: Writing Events To: " << fileName;
+}
+
+EventFileWriter::~EventFileWriter()
+{
+    //no throwing from the destructor, just push out whatever is left
+    if(bufferFill > 0)
+    {
+        outFile.write(buffer, bufferFill);
+    }
+    outFile.close();
+    delete[] buffer;
+}
+
+void EventFileWriter::acceptEvent(const Events::DppPsdEvent& event)
+{
+    if((bufferFill + static_cast<int>(sizeof(Events::DppPsdEvent))) > bufferSize)
+    {
+        this->writeBuffer();
+    }
+    std::memcpy(buffer + bufferFill, &event, sizeof(Events::DppPsdEvent));
+    bufferFill += static_cast<int>(sizeof(Events::DppPsdEvent));
+    ++eventsWritten;
+}
+
+void EventFileWriter::writeConfigChange(int channel, unsigned short address, unsigned int value,
+                                        unsigned long long wallTimeNs, unsigned long long boardTime)
+{
+    Events::DppPsdEvent marker;
+    marker.timeStamp = wallTimeNs;
+    marker.longCharge = address;
+    marker.shortCharge = static_cast<unsigned short>(value & 0xFFFFUL);
+    marker.baseline = static_cast<unsigned short>(value >> 16);
+    marker.channel = static_cast<unsigned char>(channel);
+    marker.board = Events::ConfigChangeMarker;
+    this->acceptEvent(marker);
+    marker.timeStamp = boardTime;
+    marker.board = Events::ConfigChangeBoardTime;
+    this->acceptEvent(marker);
+    eventsWritten -= 2;
+}
+
+void EventFileWriter::flush()
+{
+    this->writeBuffer();
+    outFile.flush();
+}
+
+void EventFileWriter::writeBuffer()
+{
+    if(bufferFill == 0)
+    {
+        return;
+    }
+    outFile.write(buffer, bufferFill);
+    if(!outFile.good())
+    {
+        BOOST_LOG_SEV(lg, Error) << "Output: Error Writing " << bufferFill << " Bytes To The Event File";
+        throw std::runtime_error("EventFileWriter Error - Write Failed");
+    }
+    bytesWritten += static_cast<unsigned long long>(bufferFill);
+    bytesWrittenMetric->add(static_cast<unsigned long long>(bufferFill));
+    bufferFill = 0;
+}
+
+}
@@ -0,0 +1,68 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file EventFileWriter.h
+** @author James Till Matta
+** @date 05 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the EventFileWriter class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_OUTPUT_EVENTFILEWRITER_H
+#define ORCHID_SRC_OUTPUT_EVENTFILEWRITER_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<fstream>
+// includes from other libraries
+// includes from ORCHID
+#include"Events/EventSink.h"
+#include"Metrics/Metric.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Output
+{
+
+//final stage of the event chain, packs events into a buffer and dumps the
+//buffer to disk as raw fixed size records whenever it fills
+class EventFileWriter : public Events::EventSink
+{
+public:
+    EventFileWriter(const std::string& fileName);
+    ~EventFileWriter();
+    
+    void acceptEvent(const Events::DppPsdEvent& event) override;
+    void flush() override;
+    
+    //puts a live register change marker pair into the stream, see DppPsdEvent.h
+    void writeConfigChange(int channel, unsigned short address, unsigned int value,
+                           unsigned long long wallTimeNs, unsigned long long boardTime);
+    
+    unsigned long long getEventsWritten(){return eventsWritten;}
+    unsigned long long getBytesWritten(){return bytesWritten;}
+
+private:
+    void writeBuffer();
+    
+    std::ofstream outFile;
+    char* buffer;
+    int bufferSize;
+    int bufferFill;
+    unsigned long long eventsWritten;
+    unsigned long long bytesWritten;
+    Metrics::MetricCounter* bytesWrittenMetric;
+    
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_OUTPUT_EVENTFILEWRITER_H
@@ -0,0 +1,87 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file OnlineSpectra.cpp
+** @author James Till Matta
+** @date 07 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the OnlineSpectra class
+**
+********************************************************************************
+*******************************************************************************/
+#include"OnlineSpectra.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<fstream>
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+
+namespace Output
+{
+
+OnlineSpectra::OnlineSpectra(Events::EventSink* nextStage) :
+    next(nextStage), spectra(nullptr), lg(OrchidLog::get())
+{
+    spectra = new unsigned int[SpectraChannels * SpectrumBins];
+    this->clearSpectra();
+}
+
+OnlineSpectra::~OnlineSpectra()
+{
+    delete[] spectra;
+}
+
+void OnlineSpectra::clearSpectra()
+{
+    for(int i=0; i<(SpectraChannels * SpectrumBins); ++i)
+    {
+        spectra[i] = 0;
+    }
+}
+
+unsigned long long OnlineSpectra::getChannelCount(int channel)
+{
+    if((channel < 0) || (channel >= SpectraChannels))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Output: Invalid Spectrum Channel: " << channel;
+        throw std::runtime_error("OnlineSpectra Error - Invalid Spectrum Channel");
+    }
+    unsigned long long total = 0;
+    for(int j=0; j<SpectrumBins; ++j)
+    {
+        total += spectra[(channel * SpectrumBins) + j];
+    }
+    return total;
+}
+
+//dumps the spectra as columns of "channel bin counts", skipping empty bins
+void OnlineSpectra::writeSpectra(const std::string& fileName)
+{
+    std::ofstream outFile(fileName.c_str());
+    if(!outFile.is_open())
+    {
+        BOOST_LOG_SEV(lg, Error) << "Output: Could Not Open Spectrum File: " << fileName;
+        throw std::runtime_error("OnlineSpectra Error - Could Not Open Spectrum File");
+    }
+    for(int i=0; i<SpectraChannels; ++i)
+    {
+        for(int j=0; j<SpectrumBins; ++j)
+        {
+            if(spectra[(i * SpectrumBins) + j] != 0)
+            {
+                outFile << i << " " << j << " " << spectra[(i * SpectrumBins) + j] << "\n";
+            }
+        }
+    }
+    outFile.close();
+}
+
+}
@@ -0,0 +1,66 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file OnlineSpectra.h
+** @author James Till Matta
+** @date 07 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the OnlineSpectra class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_OUTPUT_ONLINESPECTRA_H
+#define ORCHID_SRC_OUTPUT_ONLINESPECTRA_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+// includes from other libraries
+// includes from ORCHID
+#include"Events/EventSink.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Output
+{
+
+enum {SpectraChannels = 256, SpectrumBins = 4096, SpectrumBinShift = 4};
+
+//keeps a long charge spectrum for every global channel, stored as one flat
+//array with the spectrum of channel i starting at i*SpectrumBins
+//sits as a tap ahead of the coincidence filter, every event is histogrammed
+//and then handed on unchanged, so histogram only, prescaled and coincidence
+//rejected events all still show up in the spectra
+class OnlineSpectra : public Events::EventSink
+{
+public:
+    OnlineSpectra(Events::EventSink* nextStage);
+    ~OnlineSpectra();
+    
+    void acceptEvent(const Events::DppPsdEvent& event) override
+    {
+        ++spectra[(event.channel * SpectrumBins) + (event.longCharge >> SpectrumBinShift)];
+        next->acceptEvent(event);
+    }
+    void flush() override {next->flush();}
+    
+    void clearSpectra();
+    void writeSpectra(const std::string& fileName);
+    //total over every bin of one global channel
+    unsigned long long getChannelCount(int channel);
+    
+private:
+    Events::EventSink* next;
+    unsigned int* spectra;
+    
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_OUTPUT_ONLINESPECTRA_H
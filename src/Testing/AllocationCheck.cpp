@@ -0,0 +1,157 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file AllocationCheck.cpp
+** @author James Till Matta
+** @date 29 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the AllocationCheck class
+**
+********************************************************************************
+*******************************************************************************/
+#include"AllocationCheck.h"
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+#include<boost/chrono.hpp>
+// includes from ORCHID
+#include"Acquisition/EventChain.h"
+#include"Acquisition/ReadoutLoop.h"
+#include"Utility/AllocationTracker.h"
+
+namespace Testing
+{
+
+enum {ReplayAggregates = 64, ReplayEventsPerCouple = 64, ReplayCouples = 8,
+      BoardAggHeaderInts = 4, ChanAggHeaderInts = 2, ReplayEventInts = 3};
+
+AllocationCheck::AllocationCheck(double warmUpSeconds, double runSeconds) :
+    warmUpTime(warmUpSeconds), runTime(runSeconds), replayBuffer(), lg(OrchidLog::get())
+{
+    this->buildReplayBuffer();
+}
+
+bool AllocationCheck::runReplay(const std::string& outFile)
+{
+    typedef boost::chrono::steady_clock Clock;
+    BOOST_LOG_SEV(lg, Information) << "Allocation Check: Replaying Synthetic Aggregates For " << (warmUpTime + runTime) << " s";
+    Acquisition::EventChain chain(outFile, 0, 0, nullptr);
+    Events::DppPsdParser& parser = chain.getParser();
+    const unsigned int* buffer = replayBuffer.data();
+    int bufferSize = static_cast<int>(replayBuffer.size());
+
+    Clock::time_point startTime = Clock::now();
+    double elapsed = 0.0;
+    bool warmedUp = false;
+    unsigned long long allocsAtWarmUp = 0;
+    unsigned int pass = 0;
+    while(elapsed < (warmUpTime + runTime))
+    {
+        if(!warmedUp && (elapsed >= warmUpTime))
+        {
+            warmedUp = true;
+            allocsAtWarmUp = Utility::AllocationTracker::threadAllocations();
+        }
+        this->advanceReplayTime(pass);
+        parser.parseBuffer(buffer, bufferSize);
+        ++pass;
+        elapsed = boost::chrono::duration<double>(Clock::now() - startTime).count();
+    }
+    unsigned long long allocs = (Utility::AllocationTracker::threadAllocations() - allocsAtWarmUp);
+    chain.flush();
+    BOOST_LOG_SEV(lg, Information) << "Allocation Check: Replayed " << parser.getEventsParsed() << " Events, Wrote " << chain.getWriter().getBytesWritten() << " Bytes";
+    return this->report("Replay", warmedUp, allocs);
+}
+
+bool AllocationCheck::runReadout(Digitizer::Vx1730Digitizer* digi, const std::string& outFile, int processingCpu)
+{
+    BOOST_LOG_SEV(lg, Information) << "Allocation Check: Reading Out Digitizer #" << digi->getModuleNumber() << " For " << (warmUpTime + runTime) << " s";
+    digi->openDigitizer();
+    Acquisition::ReadoutLoop readout(digi, outFile, nullptr, nullptr);
+    readout.setWarmUpTime(warmUpTime);
+    readout.setProcessingCpu(processingCpu);
+    readout.run(warmUpTime + runTime);
+    digi->closeDigitizer();
+    return this->report("Readout", readout.getWarmedUp(), readout.getSteadyStateAllocations());
+}
+
+void AllocationCheck::buildReplayBuffer()
+{
+    //each board aggregate holds every couple, each couple holds events with
+    //no samples and an extras word in option 0 (time extension and baseline)
+    //the couples of an aggregate interleave in time so the sorter has to work
+    int chanAggSize = (ChanAggHeaderInts + (ReplayEventsPerCouple * ReplayEventInts));
+    int boardAggSize = (BoardAggHeaderInts + (ReplayCouples * chanAggSize));
+    replayBuffer.reserve(static_cast<std::size_t>(ReplayAggregates * boardAggSize));
+    for(int agg=0; agg<ReplayAggregates; ++agg)
+    {
+        replayBuffer.push_back(0xA0000000UL | static_cast<unsigned int>(boardAggSize));
+        replayBuffer.push_back(0x000000FFUL);
+        replayBuffer.push_back(static_cast<unsigned int>(agg));
+        replayBuffer.push_back(0);
+        for(int couple=0; couple<ReplayCouples; ++couple)
+        {
+            replayBuffer.push_back(0x80000000UL | static_cast<unsigned int>(chanAggSize));
+            replayBuffer.push_back(0x10000000UL);
+            for(int evt=0; evt<ReplayEventsPerCouple; ++evt)
+            {
+                unsigned int timeTag = static_cast<unsigned int>(16 * (((agg * ReplayEventsPerCouple + evt) * ReplayCouples) + couple + 1));
+                unsigned int longCharge = ((static_cast<unsigned int>(evt) * 977U + static_cast<unsigned int>(agg) * 131U) & 0xFFFFU);
+                replayBuffer.push_back(((static_cast<unsigned int>(evt) & 0x1U) << 31) | (timeTag & 0x7FFFFFFFUL));
+                replayBuffer.push_back(4U * 8000U);
+                replayBuffer.push_back((longCharge << 16) | (longCharge >> 2));
+            }
+        }
+    }
+}
+
+void AllocationCheck::advanceReplayTime(unsigned int pass)
+{
+    //every pass gets the next time stamp extension so the replayed stream keeps
+    //moving forward in time instead of jumping back to the start
+    unsigned int extension = ((pass & 0xFFFFU) << 16);
+    int chanAggSize = (ChanAggHeaderInts + (ReplayEventsPerCouple * ReplayEventInts));
+    int boardAggSize = (BoardAggHeaderInts + (ReplayCouples * chanAggSize));
+    for(int agg=0; agg<ReplayAggregates; ++agg)
+    {
+        for(int couple=0; couple<ReplayCouples; ++couple)
+        {
+            int offset = ((agg * boardAggSize) + BoardAggHeaderInts + (couple * chanAggSize) + ChanAggHeaderInts);
+            for(int evt=0; evt<ReplayEventsPerCouple; ++evt)
+            {
+                unsigned int& extras = replayBuffer[static_cast<std::size_t>(offset + (evt * ReplayEventInts) + 1)];
+                extras = (extension | (extras & 0xFFFFU));
+            }
+        }
+    }
+}
+
+bool AllocationCheck::report(const std::string& checkName, bool warmedUp, unsigned long long allocs)
+{
+    if(!Utility::AllocationTracker::isEnabled())
+    {
+        BOOST_LOG_SEV(lg, Error) << "Allocation Check: " << checkName << " Cannot Count Allocations, Rebuild With BUILD_TYPE=AllocTrack";
+        return false;
+    }
+    if(!warmedUp)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Allocation Check: " << checkName << " Stopped Before The End Of Warm Up";
+        return false;
+    }
+    if(allocs != 0)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Allocation Check: " << checkName << " FAILED, " << allocs << " Heap Allocations After Warm Up";
+        return false;
+    }
+    BOOST_LOG_SEV(lg, Information) << "Allocation Check: " << checkName << " Passed, No Heap Allocations After Warm Up";
+    return true;
+}
+
+}
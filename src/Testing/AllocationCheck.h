@@ -0,0 +1,64 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file AllocationCheck.h
+** @author James Till Matta
+** @date 29 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the AllocationCheck class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_TESTING_ALLOCATIONCHECK_H
+#define ORCHID_SRC_TESTING_ALLOCATIONCHECK_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Digitizer/Vx1730Digitizer.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Testing
+{
+
+//Runs the readout, parse and write chain past a warm up period and fails if
+//  the thread running it allocates from the heap after that, this needs a
+//  build with BUILD_TYPE=AllocTrack to be able to see the allocations
+//The replay check needs no hardware, it pushes a synthetic DPP-PSD buffer
+//  through the parser, sorter, spectra, filter, reducer and file writer over
+//  and over, the readout check runs the real ReadoutLoop against a digitizer
+class AllocationCheck
+{
+public:
+    AllocationCheck(double warmUpSeconds, double runSeconds);
+    ~AllocationCheck(){}
+
+    //both return true if the chain did not allocate after warm up
+    bool runReplay(const std::string& outFile);
+    //counts the readout thread and the processing thread it hands transfers to
+    bool runReadout(Digitizer::Vx1730Digitizer* digi, const std::string& outFile, int processingCpu);
+
+private:
+    void buildReplayBuffer();
+    void advanceReplayTime(unsigned int pass);
+    bool report(const std::string& checkName, bool warmedUp, unsigned long long allocs);
+
+    double warmUpTime;
+    double runTime;
+    std::vector<unsigned int> replayBuffer;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_TESTING_ALLOCATIONCHECK_H
@@ -0,0 +1,52 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file EventCollector.h
+** @author James Till Matta
+** @date 08 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the EventCollector class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_TESTING_EVENTCOLLECTOR_H
+#define ORCHID_SRC_TESTING_EVENTCOLLECTOR_H
+// includes for C system headers
+// includes for C++ system headers
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Events/EventSink.h"
+
+namespace Testing
+{
+
+//End of chain stage for the self checks, keeps everything it is handed so the
+//  output of the stage under test can be compared to what was expected
+class EventCollector : public Events::EventSink
+{
+public:
+    EventCollector() : events(), flushCount(0){}
+    ~EventCollector(){}
+
+    void acceptEvent(const Events::DppPsdEvent& event) override {events.push_back(event);}
+    void flush() override {++flushCount;}
+
+    const std::vector<Events::DppPsdEvent>& getEvents(){return events;}
+    int getFlushCount(){return flushCount;}
+
+private:
+    std::vector<Events::DppPsdEvent> events;
+    int flushCount;
+};
+
+}
+
+#endif //ORCHID_SRC_TESTING_EVENTCOLLECTOR_H
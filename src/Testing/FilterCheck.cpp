@@ -0,0 +1,317 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file FilterCheck.cpp
+** @author James Till Matta
+** @date 08 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the FilterCheck class
+**
+********************************************************************************
+*******************************************************************************/
+#include"FilterCheck.h"
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+#include"Filter/ChannelReducer.h"
+#include"Filter/CoincidenceFilter.h"
+#include"Filter/TimeSorter.h"
+#include"Output/OnlineSpectra.h"
+#include"EventCollector.h"
+
+namespace Testing
+{
+
+FilterCheck::FilterCheck() : lg(OrchidLog::get())
+{
+}
+
+bool FilterCheck::runChecks()
+{
+    //run them all even if one fails so the log shows everything that is wrong
+    bool passed = true;
+    passed = (this->checkSorter() && passed);
+    passed = (this->checkCoincidence() && passed);
+    passed = (this->checkMultiplicity() && passed);
+    passed = (this->checkVeto(false) && passed);
+    passed = (this->checkVeto(true) && passed);
+    passed = (this->checkForcedDecisions() && passed);
+    passed = (this->checkSortedChain() && passed);
+    passed = (this->checkLateChain() && passed);
+    passed = (this->checkReducerPrescale() && passed);
+    passed = (this->checkReducerThreshold() && passed);
+    passed = (this->checkHistogramOnly() && passed);
+    return passed;
+}
+
+bool FilterCheck::checkSorter()
+{
+    //a shuffled start, then a jump that releases it, then a flush
+    EventCollector collector;
+    Filter::TimeSorter sorter(&collector, 8, 10);
+    const CheckHit input[] = {{0, 5}, {0, 3}, {0, 1}, {0, 4}, {0, 2}, {0, 30}, {0, 25}, {0, 28}, {0, 50}};
+    const CheckHit expected[] = {{0, 1}, {0, 2}, {0, 3}, {0, 4}, {0, 5}, {0, 25}, {0, 28}, {0, 30}, {0, 50}};
+    this->feed(&sorter, input, 9);
+    sorter.flush();
+    bool passed = this->compare("Sorter Ordering", collector.getEvents(), expected, 9);
+    passed = (this->expectCount("Sorter Ordering", "Late Events", sorter.getLateEvents(), 0) && passed);
+    passed = (this->expectCount("Sorter Ordering", "Flushes Passed On", static_cast<unsigned long long>(collector.getFlushCount()), 1) && passed);
+
+    //a heap that is too small has to release early and an event then arrives late
+    EventCollector smallCollector;
+    Filter::TimeSorter smallSorter(&smallCollector, 3, 1000);
+    const CheckHit smallInput[] = {{0, 4}, {0, 3}, {0, 2}, {0, 1}};
+    const CheckHit smallExpected[] = {{0, 2}, {0, 1}, {0, 3}, {0, 4}};
+    this->feed(&smallSorter, smallInput, 4);
+    smallSorter.flush();
+    passed = (this->compare("Sorter Overflow", smallCollector.getEvents(), smallExpected, 4) && passed);
+    passed = (this->expectCount("Sorter Overflow", "Forced Releases", smallSorter.getForcedReleases(), 1) && passed);
+    passed = (this->expectCount("Sorter Overflow", "Late Events", smallSorter.getLateEvents(), 1) && passed);
+    return passed;
+}
+
+bool FilterCheck::checkCoincidence()
+{
+    //channels 0 and 1 need each other within 10 ticks, channel 2 is ungrouped
+    EventCollector collector;
+    Filter::CoincidenceFilter filter(&collector, 64);
+    filter.setCoincidenceWindow(10);
+    filter.setChannelGroup(0, 0);
+    filter.setChannelGroup(1, 0);
+    filter.setGroupMultiplicity(0, 2);
+    const CheckHit input[] = {{0, 100}, {1, 105}, {0, 200}, {2, 300}, {1, 400}, {0, 411}, {0, 500}, {1, 510}};
+    const CheckHit expected[] = {{0, 100}, {1, 105}, {2, 300}, {0, 500}, {1, 510}};
+    this->feed(&filter, input, 8);
+    filter.flush();
+    bool passed = this->compare("Coincidence", collector.getEvents(), expected, 5);
+    passed = (this->expectCount("Coincidence", "Events Accepted", filter.getEventsAccepted(), 5) && passed);
+    passed = (this->expectCount("Coincidence", "Forced Decisions", filter.getForcedDecisions(), 0) && passed);
+    return passed;
+}
+
+bool FilterCheck::checkMultiplicity()
+{
+    //channels 5, 6 and 7 need all three within 10 ticks, each event is judged
+    //on its own window so only the middle of the last triple passes
+    EventCollector collector;
+    Filter::CoincidenceFilter filter(&collector, 64);
+    filter.setCoincidenceWindow(10);
+    filter.setChannelGroup(5, 1);
+    filter.setChannelGroup(6, 1);
+    filter.setChannelGroup(7, 1);
+    filter.setGroupMultiplicity(1, 3);
+    const CheckHit input[] = {{5, 600}, {6, 602}, {7, 604}, {5, 700}, {6, 702}, {5, 900}, {6, 905}, {7, 915}};
+    const CheckHit expected[] = {{5, 600}, {6, 602}, {7, 604}, {6, 905}};
+    this->feed(&filter, input, 8);
+    filter.flush();
+    return this->compare("Multiplicity", collector.getEvents(), expected, 4);
+}
+
+bool FilterCheck::checkVeto(bool writeVetoChannels)
+{
+    //channel 3 vetoes channel 4 for +/- 20 ticks
+    EventCollector collector;
+    Filter::CoincidenceFilter filter(&collector, 64);
+    filter.setVetoWindow(20);
+    filter.setVetoChannel(3, true);
+    filter.setChannelVetoed(4, true);
+    filter.setWriteVetoChannels(writeVetoChannels);
+    const CheckHit input[] = {{4, 100}, {3, 400}, {4, 410}, {4, 420}, {4, 421}, {4, 985}, {3, 1000}};
+    const CheckHit expected[] = {{4, 100}, {4, 421}};
+    const CheckHit expectedWithVeto[] = {{4, 100}, {3, 400}, {4, 421}, {3, 1000}};
+    this->feed(&filter, input, 7);
+    filter.flush();
+    if(writeVetoChannels)
+    {
+        return this->compare("Veto Written", collector.getEvents(), expectedWithVeto, 4);
+    }
+    return this->compare("Veto", collector.getEvents(), expected, 2);
+}
+
+bool FilterCheck::checkForcedDecisions()
+{
+    //a four event buffer with a 1000 tick window must decide early, the
+    //channel 0 hit is decided before its partner arrives and is lost
+    EventCollector collector;
+    Filter::CoincidenceFilter filter(&collector, 4);
+    filter.setCoincidenceWindow(1000);
+    filter.setChannelGroup(0, 0);
+    filter.setChannelGroup(1, 0);
+    filter.setGroupMultiplicity(0, 2);
+    const CheckHit input[] = {{0, 0}, {2, 1}, {2, 2}, {2, 3}, {2, 4}, {1, 500}};
+    const CheckHit expected[] = {{2, 1}, {2, 2}, {2, 3}, {2, 4}};
+    this->feed(&filter, input, 6);
+    bool passed = this->expectCount("Forced Decisions", "Buffer Occupancy", static_cast<unsigned long long>(filter.getBufferOccupancy()), 4);
+    filter.flush();
+    passed = (this->compare("Forced Decisions", collector.getEvents(), expected, 4) && passed);
+    passed = (this->expectCount("Forced Decisions", "Forced Decisions", filter.getForcedDecisions(), 2) && passed);
+    return passed;
+}
+
+bool FilterCheck::checkSortedChain()
+{
+    //the coincidence stream with its pairs swapped, the sorter must put it
+    //back in order for the filter to give the same answer
+    EventCollector collector;
+    Filter::CoincidenceFilter filter(&collector, 64);
+    filter.setCoincidenceWindow(10);
+    filter.setChannelGroup(0, 0);
+    filter.setChannelGroup(1, 0);
+    filter.setGroupMultiplicity(0, 2);
+    Filter::TimeSorter sorter(&filter, 64, 50);
+    const CheckHit input[] = {{1, 105}, {0, 100}, {2, 300}, {0, 200}, {0, 411}, {1, 400}, {1, 510}, {0, 500}};
+    const CheckHit expected[] = {{0, 100}, {1, 105}, {2, 300}, {0, 500}, {1, 510}};
+    this->feed(&sorter, input, 8);
+    sorter.flush();
+    bool passed = this->compare("Sorted Chain", collector.getEvents(), expected, 5);
+    passed = (this->expectCount("Sorted Chain", "Flushes Passed On", static_cast<unsigned long long>(collector.getFlushCount()), 1) && passed);
+    return passed;
+}
+
+bool FilterCheck::checkLateChain()
+{
+    //a three event heap has to release 100 and 105 early, so 50 comes out
+    //after them, the filter must drop it and still pair the rest correctly
+    EventCollector collector;
+    Filter::CoincidenceFilter filter(&collector, 64);
+    filter.setCoincidenceWindow(10);
+    filter.setChannelGroup(0, 0);
+    filter.setChannelGroup(1, 0);
+    filter.setGroupMultiplicity(0, 2);
+    Filter::TimeSorter sorter(&filter, 3, 1000);
+    const CheckHit input[] = {{1, 130}, {0, 120}, {0, 100}, {1, 105}, {2, 50}};
+    const CheckHit expected[] = {{0, 100}, {1, 105}, {0, 120}, {1, 130}};
+    this->feed(&sorter, input, 5);
+    sorter.flush();
+    bool passed = this->compare("Late Chain", collector.getEvents(), expected, 4);
+    passed = (this->expectCount("Late Chain", "Sorter Forced Releases", sorter.getForcedReleases(), 2) && passed);
+    passed = (this->expectCount("Late Chain", "Sorter Late Events", sorter.getLateEvents(), 1) && passed);
+    passed = (this->expectCount("Late Chain", "Filter Late Events", filter.getLateEvents(), 1) && passed);
+    return passed;
+}
+
+bool FilterCheck::checkReducerPrescale()
+{
+    //channel 0 keeps one in 3 of its events at or above 100, the ones below
+    //do not count toward the prescale, channel 1 is left alone and keeps all
+    EventCollector collector;
+    Filter::ChannelReducer reducer(&collector);
+    reducer.setPrescale(0, 3);
+    reducer.setChargeThreshold(0, 100);
+    const CheckHit input[] = {{0, 1}, {1, 2}, {0, 3}, {0, 4}, {0, 5}, {1, 6}, {0, 7}, {0, 8}, {0, 9}, {0, 10}};
+    const int charges[] = {150, 0, 50, 200, 300, 10, 99, 120, 400, 500};
+    const CheckHit expected[] = {{1, 2}, {0, 5}, {1, 6}, {0, 10}};
+    this->feedCharged(&reducer, input, charges, 10);
+    reducer.flush();
+    bool passed = this->compare("Reducer Prescale", collector.getEvents(), expected, 4);
+    passed = (this->expectCount("Reducer Prescale", "Events Passed", reducer.getEventsPassed(), 4) && passed);
+    passed = (this->expectCount("Reducer Prescale", "Flushes Passed On", static_cast<unsigned long long>(collector.getFlushCount()), 1) && passed);
+    return passed;
+}
+
+bool FilterCheck::checkReducerThreshold()
+{
+    //without a prescale everything at or above the threshold is kept and
+    //everything below is dropped
+    EventCollector collector;
+    Filter::ChannelReducer reducer(&collector);
+    reducer.setChargeThreshold(2, 1000);
+    const CheckHit input[] = {{2, 10}, {2, 20}, {2, 30}, {2, 40}, {2, 50}};
+    const int charges[] = {999, 1000, 0, 65535, 1};
+    const CheckHit expected[] = {{2, 20}, {2, 40}};
+    this->feedCharged(&reducer, input, charges, 5);
+    reducer.flush();
+    return this->compare("Reducer Threshold", collector.getEvents(), expected, 2);
+}
+
+bool FilterCheck::checkHistogramOnly()
+{
+    //the acquire chain order, spectra then filter then reducer, channel 3 is
+    //histogram only so it must be in the spectra but not reach the writer
+    EventCollector collector;
+    Filter::ChannelReducer reducer(&collector);
+    reducer.setHistogramOnly(3, true);
+    Filter::CoincidenceFilter filter(&reducer, 64);
+    Output::OnlineSpectra spectra(&filter);
+    const CheckHit input[] = {{3, 10}, {4, 20}, {3, 30}, {4, 40}, {3, 50}};
+    const int charges[] = {100, 200, 300, 400, 500};
+    const CheckHit expected[] = {{4, 20}, {4, 40}};
+    this->feedCharged(&spectra, input, charges, 5);
+    spectra.flush();
+    bool passed = this->compare("Histogram Only", collector.getEvents(), expected, 2);
+    passed = (this->expectCount("Histogram Only", "Channel 3 Spectrum Counts", spectra.getChannelCount(3), 3) && passed);
+    passed = (this->expectCount("Histogram Only", "Channel 4 Spectrum Counts", spectra.getChannelCount(4), 2) && passed);
+    return passed;
+}
+
+void FilterCheck::feed(Events::EventSink* stage, const CheckHit* hits, int count)
+{
+    Events::DppPsdEvent event;
+    event.longCharge = 0;
+    event.shortCharge = 0;
+    event.baseline = 0;
+    event.board = 0;
+    for(int i=0; i<count; ++i)
+    {
+        event.timeStamp = hits[i].timeStamp;
+        event.channel = static_cast<unsigned char>(hits[i].channel);
+        stage->acceptEvent(event);
+    }
+}
+
+void FilterCheck::feedCharged(Events::EventSink* stage, const CheckHit* hits, const int* charges, int count)
+{
+    Events::DppPsdEvent event;
+    event.shortCharge = 0;
+    event.baseline = 0;
+    event.board = 0;
+    for(int i=0; i<count; ++i)
+    {
+        event.timeStamp = hits[i].timeStamp;
+        event.channel = static_cast<unsigned char>(hits[i].channel);
+        event.longCharge = static_cast<unsigned short>(charges[i]);
+        stage->acceptEvent(event);
+    }
+}
+
+bool FilterCheck::compare(const std::string& checkName, const std::vector<Events::DppPsdEvent>& output,
+                          const CheckHit* expected, int count)
+{
+    bool passed = (output.size() == static_cast<std::size_t>(count));
+    for(std::size_t i=0; passed && (i<output.size()); ++i)
+    {
+        passed = ((output[i].channel == expected[i].channel) && (output[i].timeStamp == expected[i].timeStamp));
+    }
+    if(passed)
+    {
+        BOOST_LOG_SEV(lg, Information) << "Self Check: " << checkName << " Passed";
+        return true;
+    }
+    BOOST_LOG_SEV(lg, Error) << "Self Check: " << checkName << " FAILED, Expected " << count << " Events, Got " << output.size();
+    for(std::size_t i=0; i<output.size(); ++i)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Self Check:     Got Channel " << static_cast<int>(output[i].channel) << " At " << output[i].timeStamp;
+    }
+    return false;
+}
+
+bool FilterCheck::expectCount(const std::string& checkName, const std::string& what,
+                              unsigned long long value, unsigned long long expected)
+{
+    if(value == expected)
+    {
+        return true;
+    }
+    BOOST_LOG_SEV(lg, Error) << "Self Check: " << checkName << " FAILED, " << what << " Was " << value << " Expected " << expected;
+    return false;
+}
+
+}
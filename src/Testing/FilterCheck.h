@@ -0,0 +1,84 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file FilterCheck.h
+** @author James Till Matta
+** @date 08 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the FilterCheck class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_TESTING_FILTERCHECK_H
+#define ORCHID_SRC_TESTING_FILTERCHECK_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Events/EventSink.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Testing
+{
+
+//a synthetic hit for the checks, channel and time stamp are all the sorter
+//and filter look at, the reducer checks give the long charges separately
+struct CheckHit
+{
+    int channel;
+    unsigned long long timeStamp;
+};
+
+//Hardware free checks of the time sorter, coincidence filter and channel
+//  reducer, hand built streams go through the stages into a collector and
+//  what comes out is compared to the hand worked answer
+//Covers reordering, plain coincidence, group multiplicity, veto with and
+//  without writing the veto channel, decisions forced by a full buffer, an
+//  out of order stream through the sorter into the filter, a sorter that
+//  overflows and hands the filter late events, reducer prescales and charge
+//  thresholds, and histogram only channels that fill the spectra but are not
+//  written
+class FilterCheck
+{
+public:
+    FilterCheck();
+    ~FilterCheck(){}
+
+    //returns true if every check passed
+    bool runChecks();
+
+private:
+    bool checkSorter();
+    bool checkCoincidence();
+    bool checkMultiplicity();
+    bool checkVeto(bool writeVetoChannels);
+    bool checkForcedDecisions();
+    bool checkSortedChain();
+    bool checkLateChain();
+    bool checkReducerPrescale();
+    bool checkReducerThreshold();
+    bool checkHistogramOnly();
+
+    void feed(Events::EventSink* stage, const CheckHit* hits, int count);
+    //as feed, but with a long charge for each hit, for the reducer
+    void feedCharged(Events::EventSink* stage, const CheckHit* hits, const int* charges, int count);
+    bool compare(const std::string& checkName, const std::vector<Events::DppPsdEvent>& output,
+                 const CheckHit* expected, int count);
+    bool expectCount(const std::string& checkName, const std::string& what,
+                     unsigned long long value, unsigned long long expected);
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_TESTING_FILTERCHECK_H
@@ -0,0 +1,224 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file LinkSnapshot.cpp
+** @author James Till Matta
+** @date 22 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the LinkSnapshot class
+**
+********************************************************************************
+*******************************************************************************/
+#include"LinkSnapshot.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<algorithm>
+#include<cstdlib>
+#include<fstream>
+#include<iomanip>
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+#include<boost/chrono.hpp>
+// includes from ORCHID
+
+namespace Testing
+{
+
+enum {RegClasses = 3, MaxRegsPerClass = 320};
+
+LinkSnapshot::LinkSnapshot(int linkNum, int numBoards, Utility::ThreadPlacement* placement) :
+    linkNumber(linkNum), digitizers(), addrs(), data(), counts(),
+    requests(new Digitizer::AsyncRequest[static_cast<std::size_t>(numBoards * RegClasses)]), link(nullptr),
+    lg(OrchidLog::get())
+{
+    link.reset(new Digitizer::AsyncLink(linkNumber));
+    link->setWorkerCpu(placement->getReadoutCpu(linkNumber));
+    for(int i=0; i<numBoards; ++i)
+    {
+        //boards are numbered globally, as the calibration does, the digitizer
+        //is owned before it is opened so a failure part way through closes
+        //the ones already open
+        int module = Digitizer::Vx1730Digitizer::globalModuleNumber(linkNumber, numBoards, i);
+        digitizers.emplace_back(new Digitizer::Vx1730Digitizer(module, linkNumber, i));
+        Digitizer::Vx1730Digitizer* digi = digitizers.back().get();
+        digi->openDigitizer();
+        link->addBoard(digi->getHandle(), digi->getModuleNumber());
+        for(int j=0; j<RegClasses; ++j)
+        {
+            addrs.push_back(std::vector<unsigned int>(MaxRegsPerClass, 0));
+            data.push_back(std::vector<unsigned int>(MaxRegsPerClass, 0));
+        }
+        counts.push_back(digi->fillCommonRegisterAddresses(addrs[(i * RegClasses)].data()));
+        counts.push_back(digi->fillGroupRegisterAddresses(addrs[(i * RegClasses) + 1].data()));
+        counts.push_back(digi->fillIndividualRegisterAddresses(addrs[(i * RegClasses) + 2].data()));
+    }
+}
+
+LinkSnapshot::~LinkSnapshot()
+{
+    //the link workers must be gone before the handles are closed
+    link.reset();
+    digitizers.clear();
+}
+
+void LinkSnapshot::takeSnapshot()
+{
+    //read the first board on its own, then the whole chain, if the boards'
+    //round trips overlap on the link the two times come out close
+    double singleElapsed = this->readBoards(std::min<std::size_t>(1, digitizers.size()));
+    double elapsed = this->readBoards(digitizers.size());
+
+    for(std::size_t i=0; i<addrs.size(); ++i)
+    {
+        if((i % RegClasses) == 0)
+        {
+            BOOST_LOG_SEV(lg, Information) << "Snapshot: Register Readback for Digitizer #" << digitizers[i / RegClasses]->getModuleNumber();
+            BOOST_LOG_SEV(lg, Information) << "Snapshot:   Addr |   Read   ";
+        }
+        for(int j=0; j<counts[i]; ++j)
+        {
+            BOOST_LOG_SEV(lg, Information) << "Snapshot: 0x" << std::hex << std::setw(4) << std::setfill('0') << addrs[i][static_cast<std::size_t>(j)] << " | 0x" << std::hex << std::setw(8) << std::setfill('0') << data[i][static_cast<std::size_t>(j)] << std::dec;
+        }
+    }
+    BOOST_LOG_SEV(lg, Information) << "Snapshot: Read " << digitizers.size() << " Board(s) On Link " << linkNumber << " In " << (1000.0 * elapsed) << " ms, One Board Alone Took " << (1000.0 * singleElapsed) << " ms (" << (elapsed / singleElapsed) << "x)";
+}
+
+double LinkSnapshot::readBoards(std::size_t numBoards)
+{
+    typedef boost::chrono::steady_clock Clock;
+    Clock::time_point startTime = Clock::now();
+    //queue everything up front, each board works through its own three reads
+    //while the other boards do the same
+    int pending = static_cast<int>(numBoards * RegClasses);
+    for(std::size_t i=0; i<(numBoards * RegClasses); ++i)
+    {
+        int board = static_cast<int>(i / RegClasses);
+        link->multiRead32(board, addrs[i].data(), data[i].data(), counts[i], requests[i]);
+    }
+    try
+    {
+        Digitizer::AsyncLink::waitAll(requests.get(), pending);
+    }
+    catch(std::runtime_error& err)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Snapshot: Readback On Link " << linkNumber << " Failed: " << err.what();
+        throw;
+    }
+    return boost::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+int LinkSnapshot::applyRegisterImage(const std::string& fileName)
+{
+    typedef boost::chrono::steady_clock Clock;
+    std::vector<std::vector<unsigned int> > imageAddrs(digitizers.size());
+    std::vector<std::vector<unsigned int> > imageData(digitizers.size());
+    this->readRegisterImage(fileName, imageAddrs, imageData);
+    std::vector<std::vector<unsigned int> > readback(digitizers.size());
+    for(std::size_t i=0; i<digitizers.size(); ++i)
+    {
+        readback[i].resize(imageAddrs[i].size(), 0);
+    }
+
+    //every board's writes go out together, then every board's readback
+    Clock::time_point startTime = Clock::now();
+    //each board uses the first two of its records, the write then the read
+    int pending = 0;
+    for(std::size_t i=0; i<digitizers.size(); ++i)
+    {
+        if(!imageAddrs[i].empty())
+        {
+            int count = static_cast<int>(imageAddrs[i].size());
+            link->multiWrite32(static_cast<int>(i), imageAddrs[i].data(), imageData[i].data(), count, requests[i * RegClasses]);
+            link->multiRead32(static_cast<int>(i), imageAddrs[i].data(), readback[i].data(), count, requests[(i * RegClasses) + 1]);
+        }
+        pending = static_cast<int>((i * RegClasses) + 2);
+    }
+    try
+    {
+        Digitizer::AsyncLink::waitAll(requests.get(), pending);
+    }
+    catch(std::runtime_error& err)
+    {
+        BOOST_LOG_SEV(lg, Error) << "Snapshot: Configuration Of Link " << linkNumber << " Failed: " << err.what();
+        throw;
+    }
+    double elapsed = boost::chrono::duration<double>(Clock::now() - startTime).count();
+
+    int mismatches = 0;
+    std::size_t written = 0;
+    for(std::size_t i=0; i<digitizers.size(); ++i)
+    {
+        written += imageAddrs[i].size();
+        for(std::size_t j=0; j<imageAddrs[i].size(); ++j)
+        {
+            if(readback[i][j] != imageData[i][j])
+            {
+                ++mismatches;
+                BOOST_LOG_SEV(lg, Warning) << "Snapshot: Digitizer #" << digitizers[i]->getModuleNumber() << " Register 0x" << std::hex << std::setw(4) << std::setfill('0') << imageAddrs[i][j]
+                                           << " Wrote 0x" << std::setw(8) << imageData[i][j] << " Read 0x" << std::setw(8) << readback[i][j] << std::dec;
+            }
+        }
+    }
+    BOOST_LOG_SEV(lg, Information) << "Snapshot: Wrote And Verified " << written << " Register(s) On " << digitizers.size() << " Board(s) Of Link " << linkNumber << " In " << (1000.0 * elapsed) << " ms, " << mismatches << " Mismatch(es)";
+    return mismatches;
+}
+
+void LinkSnapshot::readRegisterImage(const std::string& fileName, std::vector<std::vector<unsigned int> >& imageAddrs,
+                                     std::vector<std::vector<unsigned int> >& imageData)
+{
+    std::ifstream image(fileName.c_str());
+    if(!image.good())
+    {
+        BOOST_LOG_SEV(lg, Error) << "Snapshot: Could Not Open Register Image File: " << fileName;
+        throw std::runtime_error("LinkSnapshot Error - Could Not Open Register Image");
+    }
+    std::string line;
+    int lineNum = 0;
+    while(std::getline(image, line))
+    {
+        ++lineNum;
+        if(line.empty() || (line[0] == '#'))
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        int imageLink = -1;
+        int module = -1;
+        int channel = -1;
+        std::string name;
+        std::string addrText;
+        std::string valueText;
+        if(!(fields >> imageLink >> module >> channel >> name >> addrText >> valueText) || (imageLink < 0))
+        {
+            BOOST_LOG_SEV(lg, Error) << "Snapshot: Bad Register Image Line " << lineNum << " In " << fileName << ": " << line;
+            throw std::runtime_error("LinkSnapshot Error - Bad Register Image Line");
+        }
+        if(imageLink != linkNumber)
+        {
+            continue;
+        }
+        if((module < 0) || (static_cast<std::size_t>(module) >= digitizers.size()))
+        {
+            BOOST_LOG_SEV(lg, Error) << "Snapshot: Register Image Line " << lineNum << " In " << fileName << " Is For Board " << module << " But Link " << linkNumber << " Has " << digitizers.size() << " Board(s)";
+            throw std::runtime_error("LinkSnapshot Error - Bad Register Image Line");
+        }
+        std::size_t board = static_cast<std::size_t>(module);
+        if(imageAddrs[board].size() >= static_cast<std::size_t>(MaxRegsPerClass))
+        {
+            BOOST_LOG_SEV(lg, Error) << "Snapshot: More Than " << MaxRegsPerClass << " Registers For Module " << module << " In " << fileName;
+            throw std::runtime_error("LinkSnapshot Error - Too Many Registers In Image");
+        }
+        imageAddrs[board].push_back(static_cast<unsigned int>(std::strtoul(addrText.c_str(), nullptr, 16)));
+        imageData[board].push_back(static_cast<unsigned int>(std::strtoul(valueText.c_str(), nullptr, 16)));
+    }
+}
+
+}
@@ -0,0 +1,80 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file LinkSnapshot.h
+** @author James Till Matta
+** @date 22 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the LinkSnapshot class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_TESTING_LINKSNAPSHOT_H
+#define ORCHID_SRC_TESTING_LINKSNAPSHOT_H
+// includes for C system headers
+// includes for C++ system headers
+#include<memory>
+#include<string>
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Digitizer/Vx1730Digitizer.h"
+#include"Digitizer/AsyncLink.h"
+#include"Utility/ThreadPlacement.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Testing
+{
+
+//Reads back, or configures, the registers of every board daisy chained on one
+//optical link with all the boards' multi cycle transfers in flight at once,
+//the link workers run on the link's readout cpu
+//A snapshot also times the first board read back alone, so the log shows how
+//close the whole chain gets to the time of a single board
+//Configuration takes a register image in the format the calibration writes:
+//    <link> <board> <channel> <register name> <address> <value>
+//where board is the position on the link, lines for other links are skipped
+//so one image written by the calibration can configure each link, every board's entries go
+//out in one multi write, then are read back in one multi read and compared
+class LinkSnapshot
+{
+public:
+    LinkSnapshot(int linkNum, int numBoards, Utility::ThreadPlacement* placement);
+    ~LinkSnapshot();
+
+    void takeSnapshot();
+    //returns the number of registers that did not read back what was written
+    int applyRegisterImage(const std::string& fileName);
+
+private:
+    //reads back the first numBoards boards at once, returns the seconds taken
+    double readBoards(std::size_t numBoards);
+    void readRegisterImage(const std::string& fileName, std::vector<std::vector<unsigned int> >& imageAddrs,
+                           std::vector<std::vector<unsigned int> >& imageData);
+
+    int linkNumber;
+    //the link is declared after the digitizers so that it, and its workers,
+    //are gone before the digitizers close their handles
+    std::vector<std::unique_ptr<Digitizer::Vx1730Digitizer> > digitizers;
+    //per board address and readback arrays for the three register classes
+    std::vector<std::vector<unsigned int> > addrs;
+    std::vector<std::vector<unsigned int> > data;
+    std::vector<int> counts;
+    //completion records, one per multi cycle transfer, declared before the
+    //link so no worker is left writing to them
+    std::unique_ptr<Digitizer::AsyncRequest[]> requests;
+    std::unique_ptr<Digitizer::AsyncLink> link;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_TESTING_LINKSNAPSHOT_H
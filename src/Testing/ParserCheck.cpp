@@ -0,0 +1,159 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ParserCheck.cpp
+** @author James Till Matta
+** @date 08 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the ParserCheck class
+**
+********************************************************************************
+*******************************************************************************/
+#include"ParserCheck.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<sstream>
+// includes from other libraries
+// includes from ORCHID
+#include"Events/DppPsdParser.h"
+#include"EventCollector.h"
+
+namespace Testing
+{
+
+enum {CheckBoard = 3, CheckFirstChannel = 16, CheckCoupleMask = 0x05, CheckSampleBlocks = 1,
+      CheckHitCount = 4, BoardAggHeaderInts = 4, ChanAggHeaderInts = 2};
+
+//format word fields other than the extras option: extras and samples present,
+//analog probe 2, digital probes 5 and 3, one block of 8 samples
+static const unsigned int CheckFormat = ((1U << 28) | (1U << 27) | (2U << 22) | (5U << 19) | (3U << 16) | CheckSampleBlocks);
+//filler for the sample words, with bit 31 set so a misaligned parse shows up
+static const unsigned int SampleFiller = 0xDEADBEEF;
+
+//what goes into the aggregate, in buffer order
+struct ParserCheckHit
+{
+    int couple;
+    unsigned int oddChannel;
+    unsigned int timeTag;
+    unsigned int extension;
+    unsigned int baseline;
+    unsigned int longCharge;
+    unsigned int shortCharge;
+};
+
+static const ParserCheckHit CheckHits[CheckHitCount] =
+{
+    {0, 0, 0x12345678U, 0x0042U, 1000U, 0x1234U, 0x0567U},
+    {0, 1, 0x12345700U, 0x0042U, 1001U, 0x2345U, 0x0678U},
+    {2, 0, 0x00000010U, 0x0043U, 2000U, 0xFFFFU, 0x7FFFU},
+    {2, 1, 0x7FFFFFFFU, 0xFFFFU, 16383U, 0x0001U, 0x0002U}
+};
+
+ParserCheck::ParserCheck() : lg(OrchidLog::get())
+{
+}
+
+bool ParserCheck::runChecks()
+{
+    bool passed = true;
+    passed = (this->checkExtrasOption(0) && passed);
+    passed = (this->checkExtrasOption(2) && passed);
+    passed = (this->checkExtrasOption(5) && passed);
+    return passed;
+}
+
+bool ParserCheck::checkExtrasOption(unsigned int extrasOption)
+{
+    std::ostringstream checkName;
+    checkName << "Parser Extras Option " << extrasOption;
+    std::vector<unsigned int> buffer;
+    this->buildAggregate((CheckFormat | (extrasOption << 24)), buffer);
+    EventCollector collector;
+    Events::DppPsdParser parser(&collector, CheckBoard, CheckFirstChannel);
+    int eventCount = parser.parseBuffer(buffer.data(), static_cast<int>(buffer.size()));
+    const std::vector<Events::DppPsdEvent>& events = collector.getEvents();
+    if((parser.getParseErrors() != 0) || (eventCount != CheckHitCount) || (events.size() != CheckHitCount))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Self Check: " << checkName.str() << " FAILED, Parsed " << events.size() << " Of " << CheckHitCount << " Events With " << parser.getParseErrors() << " Errors";
+        return false;
+    }
+    bool passed = true;
+    for(int i=0; i<CheckHitCount; ++i)
+    {
+        const ParserCheckHit& hit = CheckHits[i];
+        const Events::DppPsdEvent& event = events[static_cast<std::size_t>(i)];
+        unsigned long long extension = ((extrasOption <= 2) ? hit.extension : 0ULL);
+        unsigned long long timeStamp = ((extension << 31) | hit.timeTag);
+        unsigned int baseline = ((extrasOption == 0) ? hit.baseline : 0U);
+        int channel = (CheckFirstChannel + (2 * hit.couple) + static_cast<int>(hit.oddChannel));
+        if((event.timeStamp != timeStamp) || (event.baseline != baseline) || (event.longCharge != hit.longCharge) ||
+           (event.shortCharge != hit.shortCharge) || (event.channel != channel) || (event.board != CheckBoard))
+        {
+            BOOST_LOG_SEV(lg, Error) << "Self Check: " << checkName.str() << " FAILED, Event " << i << " Gave Time " << event.timeStamp << " (Expected " << timeStamp
+                                     << ") Baseline " << event.baseline << " (" << baseline << ") Long " << event.longCharge << " (" << hit.longCharge
+                                     << ") Short " << event.shortCharge << " (" << hit.shortCharge << ") Channel " << static_cast<int>(event.channel)
+                                     << " (" << channel << ") Board " << static_cast<int>(event.board) << " (" << CheckBoard << ")";
+            passed = false;
+        }
+    }
+    if(parser.getLatestTimeStamp() != ((((extrasOption <= 2) ? 0xFFFFULL : 0ULL) << 31) | 0x7FFFFFFFULL))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Self Check: " << checkName.str() << " FAILED, Latest Time Stamp Was " << parser.getLatestTimeStamp();
+        passed = false;
+    }
+    if(passed)
+    {
+        BOOST_LOG_SEV(lg, Information) << "Self Check: " << checkName.str() << " Passed";
+    }
+    return passed;
+}
+
+void ParserCheck::buildAggregate(unsigned int format, std::vector<unsigned int>& buffer)
+{
+    //every event is the time word, the samples, the extras word, the charge word
+    buffer.clear();
+    buffer.push_back(0xA0000000U);
+    buffer.push_back(static_cast<unsigned int>(CheckCoupleMask));
+    buffer.push_back(0);
+    buffer.push_back(0);
+    for(int couple=0; couple<8; ++couple)
+    {
+        if(((CheckCoupleMask >> couple) & 0x1) == 0)
+        {
+            continue;
+        }
+        std::size_t chanAggStart = buffer.size();
+        buffer.push_back(0x80000000U);
+        buffer.push_back(format);
+        for(int i=0; i<CheckHitCount; ++i)
+        {
+            const ParserCheckHit& hit = CheckHits[i];
+            if(hit.couple != couple)
+            {
+                continue;
+            }
+            buffer.push_back((hit.oddChannel << 31) | hit.timeTag);
+            for(int j=0; j<(CheckSampleBlocks * 4); ++j)
+            {
+                buffer.push_back(SampleFiller);
+            }
+            //an extras word that holds both the time extension and baseline,
+            //it is up to the parser to take only what the option provides
+            buffer.push_back((hit.extension << 16) | (4U * hit.baseline));
+            buffer.push_back((hit.longCharge << 16) | hit.shortCharge);
+        }
+        int chanAggSize = static_cast<int>(buffer.size() - chanAggStart);
+        buffer[chanAggStart] |= static_cast<unsigned int>(chanAggSize);
+    }
+    buffer[0] |= static_cast<unsigned int>(buffer.size());
+}
+
+}
@@ -0,0 +1,56 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ParserCheck.h
+** @author James Till Matta
+** @date 08 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the ParserCheck class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_TESTING_PARSERCHECK_H
+#define ORCHID_SRC_TESTING_PARSERCHECK_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Utility/OrchidLogger.h"
+
+namespace Testing
+{
+
+//Hardware free checks of the DPP-PSD parser, a board aggregate is built by
+//  hand with samples on, the analog and both digital probe fields set to non
+//  default values, and the extras option under test, then parsed and every
+//  field of every event compared to what went in
+//Extras option 0 must give the time extension and baseline, option 2 only
+//  the time extension, and option 5 neither
+class ParserCheck
+{
+public:
+    ParserCheck();
+    ~ParserCheck(){}
+
+    //returns true if every check passed
+    bool runChecks();
+
+private:
+    bool checkExtrasOption(unsigned int extrasOption);
+    void buildAggregate(unsigned int format, std::vector<unsigned int>& buffer);
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_TESTING_PARSERCHECK_H
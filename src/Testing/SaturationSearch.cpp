@@ -0,0 +1,299 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file SaturationSearch.cpp
+** @author James Till Matta
+** @date 14 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the SaturationSearch class
+**
+********************************************************************************
+*******************************************************************************/
+#include"SaturationSearch.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<iomanip>
+#include<sstream>
+#include<stdexcept>
+// includes from other libraries
+#include<boost/chrono.hpp>
+// includes from ORCHID
+
+namespace Testing
+{
+
+enum {MaxTriggersPerPass = 256};
+
+typedef boost::chrono::steady_clock Clock;
+
+static const unsigned int AcqStatusMemFullBit = 0x00000010;
+static const double StageFullFraction = 0.9;
+static const double TriggerRateTolerance = 0.95;
+
+SaturationSearch::SaturationSearch(Digitizer::Vx1730Digitizer* digitizer, const std::string& outFile) :
+    digi(digitizer), readout(digitizer, outFile, nullptr, nullptr), stepDuration(2.0),
+    individualTrigger(false), triggerChannel(-1), stageNames(), stageDepths(),
+    stageCapacities(), results(), lg(OrchidLog::get())
+{
+    //the sorter and filter live on the processing thread, what the readout
+    //can see of them is how much work is queued up waiting for that thread
+    this->addStageProbe("Processing Queue", [this](){return readout.getQueuedItems();}, Acquisition::ProcessQueueSize);
+    this->addStageProbe("Transfer Buffers (Processing Thread)", [this](){return (Acquisition::TransferBufferCount - readout.getFreeBuffers());}, Acquisition::TransferBufferCount);
+}
+
+SaturationSearch::~SaturationSearch()
+{
+}
+
+void SaturationSearch::addStageProbe(const std::string& name, std::function<int()> depth, int capacity)
+{
+    stageNames.push_back(name);
+    stageDepths.push_back(depth);
+    stageCapacities.push_back(capacity);
+}
+
+void SaturationSearch::runSoftwareTriggerScan(double startRate, double maxRate, double stepFactor)
+{
+    BOOST_LOG_SEV(lg, Information) << "Saturation Search: Software Trigger Scan From " << startRate << " To " << maxRate << " Triggers/s On Digitizer #" << digi->getModuleNumber();
+    individualTrigger = false;
+    triggerChannel = -1;
+    this->runRateScan(startRate, maxRate, stepFactor);
+}
+
+void SaturationSearch::runIndividualTriggerScan(double startRate, double maxRate, double stepFactor, int channel)
+{
+    if(channel < 0)
+    {
+        BOOST_LOG_SEV(lg, Information) << "Saturation Search: Individual Trigger Scan From " << startRate << " To " << maxRate << " Triggers/s On All Channels Of Digitizer #" << digi->getModuleNumber();
+    }
+    else
+    {
+        BOOST_LOG_SEV(lg, Information) << "Saturation Search: Individual Trigger Scan From " << startRate << " To " << maxRate << " Triggers/s On Channel " << channel << " Of Digitizer #" << digi->getModuleNumber();
+    }
+    individualTrigger = true;
+    triggerChannel = channel;
+    this->runRateScan(startRate, maxRate, stepFactor);
+}
+
+void SaturationSearch::runRateScan(double startRate, double maxRate, double stepFactor)
+{
+    //the rate is multiplied up each step so anything else would never end
+    if(!(startRate > 0.0) || !(stepFactor > 1.0) || !(maxRate >= startRate))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Saturation Search: Invalid Software Trigger Scan, Start: " << startRate << " Max: " << maxRate << " Step Factor: " << stepFactor << ", Need 0 < Start <= Max And Step Factor > 1";
+        throw std::runtime_error("SaturationSearch Error - Invalid Software Trigger Scan Parameters");
+    }
+    results.clear();
+    readout.begin();
+    try
+    {
+        for(double rate = startRate; rate <= maxRate; rate *= stepFactor)
+        {
+            results.push_back(this->runStep(rate, rate));
+            if(!results.back().sustainable)
+            {
+                break;
+            }
+        }
+        readout.end();
+    }
+    catch(...)
+    {
+        readout.abort();
+        throw;
+    }
+    this->reportResults("Triggers/s");
+}
+
+void SaturationSearch::runThresholdScan(unsigned int startThreshold, unsigned int stopThreshold, unsigned int stepSize)
+{
+    if((stepSize == 0) || (startThreshold < stopThreshold))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Saturation Search: Invalid Threshold Scan, Start: " << startThreshold << " Stop: " << stopThreshold << " Step: " << stepSize << ", Need Start >= Stop And Step > 0";
+        throw std::runtime_error("SaturationSearch Error - Invalid Threshold Scan Parameters");
+    }
+    BOOST_LOG_SEV(lg, Information) << "Saturation Search: Threshold Scan From " << startThreshold << " Down To " << stopThreshold << " On Digitizer #" << digi->getModuleNumber();
+    results.clear();
+    readout.begin();
+    try
+    {
+        for(unsigned int thresh = startThreshold; thresh >= stopThreshold; thresh -= stepSize)
+        {
+            digi->setAllTriggerThresholds(thresh);
+            results.push_back(this->runStep(static_cast<double>(thresh), 0.0));
+            if(!results.back().sustainable || (thresh < (stopThreshold + stepSize)))
+            {
+                break;
+            }
+        }
+        readout.end();
+    }
+    catch(...)
+    {
+        readout.abort();
+        throw;
+    }
+    this->reportResults("Threshold");
+}
+
+SaturationStep SaturationSearch::runStep(double setting, double triggerRate)
+{
+    SaturationStep step;
+    step.setting = setting;
+    step.triggerRate = 0.0;
+    step.eventRate = 0.0;
+    step.readoutMBps = 0.0;
+    step.worstStageFill = 0.0;
+    step.readFraction = 0.0;
+    step.bufferWaits = 0;
+    step.maxEventSize = 0;
+    step.worstStage = -1;
+    step.boardFull = false;
+    step.sustainable = true;
+    step.limitedBy = "None";
+
+    unsigned long long triggersFired = 0;
+    unsigned long long bytesAtStart = readout.getBytesRead();
+    unsigned long long eventsAtStart = readout.getEventsParsed();
+    unsigned long long waitsAtStart = readout.getBufferWaits();
+    double readTime = 0.0;
+    Clock::time_point startTime = Clock::now();
+    double elapsed = 0.0;
+    while(elapsed < stepDuration)
+    {
+        //fire however many triggers we are behind by, in limited bunches so
+        //that the readout still gets a look in at high rates
+        unsigned long long target = static_cast<unsigned long long>(triggerRate * elapsed);
+        for(int i=0; (i < MaxTriggersPerPass) && (triggersFired < target); ++i)
+        {
+            this->fireTrigger();
+            ++triggersFired;
+        }
+        //sample the board
+        if((digi->readAcquisitionStatus() & AcqStatusMemFullBit) != 0)
+        {
+            step.boardFull = true;
+        }
+        unsigned int eventSize = digi->readEventSize();
+        if(eventSize > step.maxEventSize)
+        {
+            step.maxEventSize = eventSize;
+        }
+        //one pass of the readout, a pass that pulled a transfer counts as
+        //read time, including any wait for the processing to free a buffer
+        Clock::time_point pollStart = Clock::now();
+        if(readout.poll())
+        {
+            readTime += boost::chrono::duration<double>(Clock::now() - pollStart).count();
+        }
+        //sample the stages downstream of the readout
+        for(std::size_t i=0; i<stageDepths.size(); ++i)
+        {
+            double fill = (static_cast<double>(stageDepths[i]()) / static_cast<double>(stageCapacities[i]));
+            if(fill > step.worstStageFill)
+            {
+                step.worstStageFill = fill;
+                step.worstStage = static_cast<int>(i);
+            }
+        }
+        elapsed = boost::chrono::duration<double>(Clock::now() - startTime).count();
+    }
+    step.triggerRate = (static_cast<double>(triggersFired) / elapsed);
+    //the processing thread may still be working through this step's
+    //transfers, so this lags the readout rate when processing is the limit
+    step.eventRate = (static_cast<double>(readout.getEventsParsed() - eventsAtStart) / elapsed);
+    step.readoutMBps = ((static_cast<double>(readout.getBytesRead() - bytesAtStart) / elapsed) / 1.0e6);
+    step.readFraction = (readTime / elapsed);
+    step.bufferWaits = (readout.getBufferWaits() - waitsAtStart);
+
+    //decide if this rate can be held and if not what gave out first
+    if(step.boardFull)
+    {
+        //if the readout ever had to wait for the processing thread to hand a
+        //buffer back, that is what kept it from emptying the board
+        step.sustainable = false;
+        if((step.bufferWaits > 0) || (step.worstStageFill >= StageFullFraction))
+        {
+            step.limitedBy = "Event Processing (Parse / Sort / Filter / Write)";
+        }
+        else
+        {
+            step.limitedBy = "Board Readout (Block Transfer / Optical Link)";
+        }
+    }
+    else if(step.worstStageFill >= StageFullFraction)
+    {
+        step.sustainable = false;
+        step.limitedBy = stageNames[static_cast<std::size_t>(step.worstStage)];
+    }
+    else if((triggerRate > 0.0) && (step.triggerRate < (TriggerRateTolerance * triggerRate)))
+    {
+        step.sustainable = false;
+        step.limitedBy = "Software Trigger Generation (Register Write Latency)";
+    }
+    BOOST_LOG_SEV(lg, Information) << "Saturation Search: Step " << setting << " -> " << step.triggerRate << " Triggers/s, " << step.eventRate << " Events/s, " << step.readoutMBps << " MB/s, Max EventSize: " << step.maxEventSize << ", Board Full: " << (step.boardFull ? "Yes" : "No") << ", Read Time: " << (100.0 * step.readFraction) << "%, Buffer Waits: " << step.bufferWaits;
+    return step;
+}
+
+void SaturationSearch::fireTrigger()
+{
+    if(individualTrigger)
+    {
+        digi->fireIndividualSoftwareTrigger(triggerChannel);
+    }
+    else
+    {
+        digi->fireSoftwareTrigger();
+    }
+}
+
+void SaturationSearch::reportResults(const std::string& settingName)
+{
+    BOOST_LOG_SEV(lg, Information) << "Saturation Search: Results For Digitizer #" << digi->getModuleNumber();
+    BOOST_LOG_SEV(lg, Information) << "Saturation Search: " << std::setw(12) << settingName << " | Trig/s       | Events/s     | MB/s     | MaxEvSize | Stage Fill | Board Full | Limited By";
+    int lastGood = -1;
+    for(std::size_t i=0; i<results.size(); ++i)
+    {
+        const SaturationStep& step = results[i];
+        std::ostringstream stageFill;
+        stageFill << std::fixed << std::setprecision(1) << (100.0 * step.worstStageFill) << "%";
+        BOOST_LOG_SEV(lg, Information) << "Saturation Search: " << std::setw(12) << step.setting << " | "
+                                       << std::setw(12) << step.triggerRate << " | "
+                                       << std::setw(12) << step.eventRate << " | "
+                                       << std::setw(8) << step.readoutMBps << " | "
+                                       << std::setw(9) << step.maxEventSize << " | "
+                                       << std::setw(10) << stageFill.str() << " | "
+                                       << std::setw(10) << (step.boardFull ? "Yes" : "No") << " | "
+                                       << step.limitedBy;
+        if(step.sustainable)
+        {
+            lastGood = static_cast<int>(i);
+        }
+    }
+    if(lastGood < 0)
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Saturation Search: No Step Was Sustainable";
+    }
+    else
+    {
+        const SaturationStep& good = results[static_cast<std::size_t>(lastGood)];
+        BOOST_LOG_SEV(lg, Information) << "Saturation Search: Maximum Sustainable " << settingName << ": " << good.setting << " (" << good.triggerRate << " Triggers/s, " << good.eventRate << " Events/s, " << good.readoutMBps << " MB/s)";
+    }
+    if(!results.empty() && !results.back().sustainable)
+    {
+        BOOST_LOG_SEV(lg, Information) << "Saturation Search: Limiting Stage: " << results.back().limitedBy;
+    }
+    else
+    {
+        BOOST_LOG_SEV(lg, Information) << "Saturation Search: The Scan Range Ended Before Anything Saturated";
+    }
+}
+
+}
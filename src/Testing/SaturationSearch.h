@@ -0,0 +1,113 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file SaturationSearch.h
+** @author James Till Matta
+** @date 14 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the SaturationSearch class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_TESTING_SATURATIONSEARCH_H
+#define ORCHID_SRC_TESTING_SATURATIONSEARCH_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<vector>
+#include<functional>
+// includes from other libraries
+// includes from ORCHID
+#include"Acquisition/ReadoutLoop.h"
+#include"Digitizer/Vx1730Digitizer.h"
+#include"Utility/OrchidLogger.h"
+
+namespace Testing
+{
+
+//the measurements taken at a single rate step
+struct SaturationStep
+{
+    double setting;             //requested triggers per second or threshold
+    double triggerRate;         //software triggers per second actually fired
+    double eventRate;           //events per second parsed from the readout
+    double readoutMBps;         //data pulled off the board per second
+    double worstStageFill;      //highest fill fraction seen among the stages
+    double readFraction;        //share of the step spent pulling transfers
+    unsigned long long bufferWaits; //times the readout waited for a free transfer buffer
+    unsigned int maxEventSize;  //largest EventSize register value seen
+    int worstStage;             //index of the fullest stage, -1 if no stages
+    bool boardFull;             //the board memory reported full at least once
+    bool sustainable;
+    std::string limitedBy;
+};
+
+//Raises the input rate on a digitizer step by step until the chain can no
+//  longer keep up, either by firing board or individual channel software
+//  triggers at an increasing rate or by walking the broadcast trigger
+//  threshold down into the noise
+//The board is read out by the same ReadoutLoop as the acquire mode, so the
+//  transfers go to a processing thread on its own cpu and through the same
+//  parser, sorter, spectra, coincidence filter, reducer and file writer, the
+//  search fires the triggers between the loop's polls
+//The processing thread's item queue and its transfer buffers in use are
+//  registered as stage probes and more can be added
+//At each step the block transfer throughput, the parsed event rate, the
+//  board state via the AcquisitionStatus and EventSize registers, the depth
+//  of each stage probe, the share of the step spent pulling transfers and the
+//  times the readout had to wait for a free transfer buffer are sampled, the
+//  first step where the board fills, a stage passes 90% full, or the triggers
+//  cannot be fired fast enough ends the search and names the limiting stage,
+//  a full board is blamed on the processing if the readout had to wait for
+//  it during the step and on the transfers otherwise
+class SaturationSearch
+{
+public:
+    SaturationSearch(Digitizer::Vx1730Digitizer* digitizer, const std::string& outFile);
+    ~SaturationSearch();
+
+    //probes are called on the readout thread between polls
+    void addStageProbe(const std::string& name, std::function<int()> depth, int capacity);
+    void setStepDuration(double seconds){stepDuration = seconds;}
+    //the cpu the parse, sort, filter and write thread pins itself to
+    void setProcessingCpu(int cpuNum){readout.setProcessingCpu(cpuNum);}
+
+    //the digitizer must already be open and configured
+    void runSoftwareTriggerScan(double startRate, double maxRate, double stepFactor);
+    //fires IndivSoftwTrig on one channel, or on all of them through the
+    //broadcast address if channel is negative
+    void runIndividualTriggerScan(double startRate, double maxRate, double stepFactor, int channel);
+    void runThresholdScan(unsigned int startThreshold, unsigned int stopThreshold, unsigned int stepSize);
+
+private:
+    void runRateScan(double startRate, double maxRate, double stepFactor);
+    SaturationStep runStep(double setting, double triggerRate);
+    void fireTrigger();
+    void reportResults(const std::string& settingName);
+
+    Digitizer::Vx1730Digitizer* digi;
+    Acquisition::ReadoutLoop readout;
+    double stepDuration;
+    //which software trigger the rate scans fire, the board level SoftwareTrg
+    //or IndivSoftwTrig on triggerChannel (negative for the broadcast)
+    bool individualTrigger;
+    int triggerChannel;
+    std::vector<std::string> stageNames;
+    std::vector<std::function<int()> > stageDepths;
+    std::vector<int> stageCapacities;
+
+    std::vector<SaturationStep> results;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_TESTING_SATURATIONSEARCH_H
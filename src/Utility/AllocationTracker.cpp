@@ -0,0 +1,143 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file AllocationTracker.cpp
+** @author James Till Matta
+** @date 29 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the AllocationTracker class, and in the
+** AllocTrack build the replacement global allocation functions
+**
+********************************************************************************
+*******************************************************************************/
+#include"AllocationTracker.h"
+// includes for C system headers
+// includes for C++ system headers
+#include<cstdlib>
+#include<new>
+// includes from other libraries
+// includes from ORCHID
+
+#ifdef ORCHID_TRACK_ALLOCATIONS
+
+//plain old data thread locals need no construction, so they are safe to touch
+//from inside operator new no matter how early a thread allocates
+static thread_local unsigned long long threadAllocCount = 0;
+static thread_local unsigned long long threadAllocBytes = 0;
+
+static void* countedAllocate(std::size_t size)
+{
+    ++threadAllocCount;
+    threadAllocBytes += size;
+    return std::malloc((size == 0) ? 1 : size);
+}
+
+void* operator new(std::size_t size)
+{
+    void* mem = countedAllocate(size);
+    if(mem == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return mem;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* mem = countedAllocate(size);
+    if(mem == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return mem;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* mem) noexcept
+{
+    std::free(mem);
+}
+
+void operator delete[](void* mem) noexcept
+{
+    std::free(mem);
+}
+
+void operator delete(void* mem, std::size_t) noexcept
+{
+    std::free(mem);
+}
+
+void operator delete[](void* mem, std::size_t) noexcept
+{
+    std::free(mem);
+}
+
+void operator delete(void* mem, const std::nothrow_t&) noexcept
+{
+    std::free(mem);
+}
+
+void operator delete[](void* mem, const std::nothrow_t&) noexcept
+{
+    std::free(mem);
+}
+
+#endif //ORCHID_TRACK_ALLOCATIONS
+
+namespace Utility
+{
+
+#ifdef ORCHID_TRACK_ALLOCATIONS
+
+bool AllocationTracker::isEnabled()
+{
+    return true;
+}
+
+unsigned long long AllocationTracker::threadAllocations()
+{
+    return threadAllocCount;
+}
+
+unsigned long long AllocationTracker::threadAllocatedBytes()
+{
+    return threadAllocBytes;
+}
+
+#else
+
+bool AllocationTracker::isEnabled()
+{
+    return false;
+}
+
+unsigned long long AllocationTracker::threadAllocations()
+{
+    return 0;
+}
+
+unsigned long long AllocationTracker::threadAllocatedBytes()
+{
+    return 0;
+}
+
+#endif //ORCHID_TRACK_ALLOCATIONS
+
+}
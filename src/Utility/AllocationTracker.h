@@ -0,0 +1,45 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file AllocationTracker.h
+** @author James Till Matta
+** @date 29 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the AllocationTracker class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_UTILITY_ALLOCATIONTRACKER_H
+#define ORCHID_SRC_UTILITY_ALLOCATIONTRACKER_H
+// includes for C system headers
+// includes for C++ system headers
+// includes from other libraries
+// includes from ORCHID
+
+namespace Utility
+{
+
+//Per thread heap allocation counts
+//When built with ORCHID_TRACK_ALLOCATIONS defined (BUILD_TYPE=AllocTrack) the
+//  global operator new and delete are replaced with versions that bump a
+//  thread local count before going to malloc, in any other build nothing is
+//  replaced and the counts stay at zero
+class AllocationTracker
+{
+public:
+    static bool isEnabled();
+    //allocations made by the calling thread since it started
+    static unsigned long long threadAllocations();
+    static unsigned long long threadAllocatedBytes();
+};
+
+}
+
+#endif //ORCHID_SRC_UTILITY_ALLOCATIONTRACKER_H
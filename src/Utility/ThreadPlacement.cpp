@@ -0,0 +1,373 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ThreadPlacement.cpp
+** @author James Till Matta
+** @date 11 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Implementation file for the ThreadPlacement class
+**
+********************************************************************************
+*******************************************************************************/
+#include"ThreadPlacement.h"
+// includes for C system headers
+#include<pthread.h>
+#include<sched.h>
+#include<dirent.h>
+#include<unistd.h>
+// includes for C++ system headers
+#include<cstring>
+#include<cstdlib>
+#include<fstream>
+#include<sstream>
+#include<algorithm>
+#include<stdexcept>
+// includes from other libraries
+// includes from ORCHID
+
+namespace Utility
+{
+
+static const char* CardDriverDir = "/sys/bus/pci/drivers/a3818";
+static const char* PciDeviceDir = "/sys/bus/pci/devices/";
+static const char* NodeDir = "/sys/devices/system/node/node";
+static const char* OnlineCpuFile = "/sys/devices/system/cpu/online";
+
+ThreadPlacement::ThreadPlacement(int numberOfLinks, int linksPerCard) :
+    numLinks(numberOfLinks), linksPerCardCount(linksPerCard), numNodes(0),
+    cardAddresses(), cardNodes(), cardIrqCpus(), nodeCpus(), readoutCpus(),
+    processingCpus(), lg(OrchidLog::get())
+{
+    if(linksPerCardCount < 1)
+    {
+        linksPerCardCount = 1;
+    }
+}
+
+void ThreadPlacement::discoverTopology()
+{
+    //get the cpus of each node, machines without NUMA get a single node
+    nodeCpus.clear();
+    for(int i=0; ; ++i)
+    {
+        std::ostringstream nodePath;
+        nodePath << NodeDir << i;
+        if(access(nodePath.str().c_str(), F_OK) != 0)
+        {
+            break;
+        }
+        nodeCpus.push_back(this->readCpuList(nodePath.str() + "/cpulist"));
+    }
+    if(nodeCpus.empty())
+    {
+        nodeCpus.push_back(this->readCpuList(OnlineCpuFile));
+    }
+    numNodes = static_cast<int>(nodeCpus.size());
+
+    this->findCards();
+    this->buildLayout();
+}
+
+void ThreadPlacement::logLayout()
+{
+    BOOST_LOG_SEV(lg, Information) << "Placement: Found " << numNodes << " NUMA Node(s) And " << cardAddresses.size() << " A3818 Card(s)";
+    for(int i=0; i<numNodes; ++i)
+    {
+        std::ostringstream cpus;
+        for(std::size_t j=0; j<nodeCpus[i].size(); ++j)
+        {
+            cpus << " " << nodeCpus[i][j];
+        }
+        BOOST_LOG_SEV(lg, Information) << "Placement:   Node " << i << " CPUs:" << cpus.str();
+    }
+    for(std::size_t i=0; i<cardAddresses.size(); ++i)
+    {
+        std::ostringstream cpus;
+        for(std::size_t j=0; j<cardIrqCpus[i].size(); ++j)
+        {
+            cpus << " " << cardIrqCpus[i][j];
+        }
+        BOOST_LOG_SEV(lg, Information) << "Placement:   Card " << i << " At " << cardAddresses[i] << " On Node " << cardNodes[i] << " IRQ CPUs:" << cpus.str();
+    }
+    if(cardAddresses.empty())
+    {
+        BOOST_LOG_SEV(lg, Warning) << "Placement: No A3818 Found Under " << CardDriverDir << ", Assuming Node 0";
+    }
+    for(int i=0; i<numLinks; ++i)
+    {
+        BOOST_LOG_SEV(lg, Information) << "Placement:   Link " << i << " Readout Thread -> CPU " << readoutCpus[i] << " (Node " << this->getLinkNumaNode(i) << ")";
+    }
+    std::ostringstream procCpus;
+    for(std::size_t i=0; i<processingCpus.size(); ++i)
+    {
+        procCpus << " " << processingCpus[i];
+    }
+    BOOST_LOG_SEV(lg, Information) << "Placement:   Helper Threads -> CPUs (In Order Of Use):" << procCpus.str();
+}
+
+int ThreadPlacement::getLinkNumaNode(int link)
+{
+    std::size_t card = static_cast<std::size_t>(link / linksPerCardCount);
+    if(card < cardNodes.size())
+    {
+        return cardNodes[card];
+    }
+    return 0;
+}
+
+int ThreadPlacement::getReadoutCpu(int link)
+{
+    //wrapping would quietly put two links' readout threads on one core
+    if((link < 0) || (link >= static_cast<int>(readoutCpus.size())))
+    {
+        BOOST_LOG_SEV(lg, Error) << "Placement: Link " << link << " Has No Readout CPU, Placement Was Built For " << readoutCpus.size() << " Links";
+        throw std::runtime_error("ThreadPlacement Error - Link Out Of Range");
+    }
+    return readoutCpus[static_cast<std::size_t>(link)];
+}
+
+int ThreadPlacement::getProcessingCpu(int index)
+{
+    return processingCpus[static_cast<std::size_t>(index) % processingCpus.size()];
+}
+
+bool ThreadPlacement::pinToReadoutCpu(int link)
+{
+    return pinCallingThread(this->getReadoutCpu(link));
+}
+
+bool ThreadPlacement::pinToProcessingCpu(int index)
+{
+    return pinCallingThread(this->getProcessingCpu(index));
+}
+
+char* ThreadPlacement::allocateLocalBuffer(std::size_t size)
+{
+    char* buffer = new char[size];
+    //writing every byte forces the pages to be faulted in now, on our node
+    std::memset(buffer, 0, size);
+    return buffer;
+}
+
+void ThreadPlacement::findCards()
+{
+    cardAddresses.clear();
+    cardNodes.clear();
+    cardIrqCpus.clear();
+    DIR* drvDir = opendir(CardDriverDir);
+    if(drvDir == nullptr)
+    {
+        return;
+    }
+    //the driver directory holds a link named by PCI address for each card
+    struct dirent* entry = nullptr;
+    while((entry = readdir(drvDir)) != nullptr)
+    {
+        if(std::strchr(entry->d_name, ':') != nullptr)
+        {
+            cardAddresses.push_back(std::string(entry->d_name));
+        }
+    }
+    closedir(drvDir);
+    std::sort(cardAddresses.begin(), cardAddresses.end());
+
+    for(std::size_t i=0; i<cardAddresses.size(); ++i)
+    {
+        std::string devPath = std::string(PciDeviceDir) + cardAddresses[i];
+        int node = this->readIntFromFile(devPath + "/numa_node", 0);
+        //the kernel reports -1 when the machine is not NUMA
+        if((node < 0) || (node >= numNodes))
+        {
+            node = 0;
+        }
+        cardNodes.push_back(node);
+        std::vector<int> irqCpus;
+        this->findCardIrqCpus(devPath, irqCpus);
+        cardIrqCpus.push_back(irqCpus);
+    }
+}
+
+void ThreadPlacement::findCardIrqCpus(const std::string& devPath, std::vector<int>& irqCpus)
+{
+    std::vector<int> irqs;
+    int legacyIrq = this->readIntFromFile(devPath + "/irq", 0);
+    if(legacyIrq > 0)
+    {
+        irqs.push_back(legacyIrq);
+    }
+    DIR* msiDir = opendir((devPath + "/msi_irqs").c_str());
+    if(msiDir != nullptr)
+    {
+        struct dirent* entry = nullptr;
+        while((entry = readdir(msiDir)) != nullptr)
+        {
+            if(entry->d_name[0] != '.')
+            {
+                irqs.push_back(std::atoi(entry->d_name));
+            }
+        }
+        closedir(msiDir);
+    }
+    for(std::size_t i=0; i<irqs.size(); ++i)
+    {
+        std::ostringstream irqPath;
+        irqPath << "/proc/irq/" << irqs[i];
+        //prefer where the interrupt actually lands over where it may land
+        std::vector<int> cpus = this->readCpuList(irqPath.str() + "/effective_affinity_list");
+        if(cpus.empty())
+        {
+            cpus = this->readCpuList(irqPath.str() + "/smp_affinity_list");
+        }
+        irqCpus.insert(irqCpus.end(), cpus.begin(), cpus.end());
+    }
+    std::sort(irqCpus.begin(), irqCpus.end());
+    irqCpus.erase(std::unique(irqCpus.begin(), irqCpus.end()), irqCpus.end());
+}
+
+void ThreadPlacement::buildLayout()
+{
+    std::vector<int> used;
+    readoutCpus.clear();
+    processingCpus.clear();
+    //memory only nodes have no cpus, threads for cards there go anywhere
+    std::vector<int> allCpus = this->readCpuList(OnlineCpuFile);
+    if(allCpus.empty())
+    {
+        allCpus.push_back(0);
+    }
+    //first give each readout thread a core on its card's node, staying off the
+    //cores that take the card interrupt if there are enough cores to do so
+    for(int i=0; i<numLinks; ++i)
+    {
+        int node = this->getLinkNumaNode(i);
+        std::size_t card = static_cast<std::size_t>(i / linksPerCardCount);
+        std::vector<int> irqCpus;
+        if(card < cardIrqCpus.size())
+        {
+            irqCpus = cardIrqCpus[card];
+        }
+        const std::vector<int>& cpus = (nodeCpus[static_cast<std::size_t>(node)].empty() ? allCpus : nodeCpus[static_cast<std::size_t>(node)]);
+        int choice = -1;
+        int fallback = -1;
+        for(std::size_t j=0; j<cpus.size(); ++j)
+        {
+            if(std::find(used.begin(), used.end(), cpus[j]) != used.end())
+            {
+                continue;
+            }
+            if(fallback < 0)
+            {
+                fallback = cpus[j];
+            }
+            if(std::find(irqCpus.begin(), irqCpus.end(), cpus[j]) == irqCpus.end())
+            {
+                choice = cpus[j];
+                break;
+            }
+        }
+        if(choice < 0)
+        {
+            choice = fallback;
+        }
+        if(choice < 0)
+        {
+            //more links than cores on the node, double up
+            choice = cpus[static_cast<std::size_t>(i) % cpus.size()];
+        }
+        readoutCpus.push_back(choice);
+        used.push_back(choice);
+    }
+    //then hand out the rest, nearest node (that of the first card) first
+    int firstNode = this->getLinkNumaNode(0);
+    for(int i=0; i<numNodes; ++i)
+    {
+        int node = ((firstNode + i) % numNodes);
+        const std::vector<int>& cpus = nodeCpus[static_cast<std::size_t>(node)];
+        for(std::size_t j=0; j<cpus.size(); ++j)
+        {
+            if(std::find(used.begin(), used.end(), cpus[j]) == used.end())
+            {
+                processingCpus.push_back(cpus[j]);
+            }
+        }
+    }
+    if(processingCpus.empty())
+    {
+        processingCpus = allCpus;
+    }
+}
+
+bool ThreadPlacement::pinCallingThread(int cpu)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if(cpu < 0)
+    {
+        long numCpus = sysconf(_SC_NPROCESSORS_CONF);
+        for(long i=0; (i<numCpus) && (i<CPU_SETSIZE); ++i)
+        {
+            CPU_SET(static_cast<std::size_t>(i), &cpuSet);
+        }
+    }
+    else if(cpu < CPU_SETSIZE)
+    {
+        CPU_SET(static_cast<std::size_t>(cpu), &cpuSet);
+    }
+    else
+    {
+        BOOST_LOG_SEV(OrchidLog::get(), Warning) << "Placement: Could Not Pin Thread To CPU " << cpu << " - Beyond CPU_SETSIZE (" << CPU_SETSIZE << ")";
+        return false;
+    }
+    int retVal = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+    if(retVal != 0)
+    {
+        BOOST_LOG_SEV(OrchidLog::get(), Warning) << "Placement: Could Not Pin Thread To CPU " << cpu << " - " << std::strerror(retVal);
+        return false;
+    }
+    return true;
+}
+
+//parses the kernel's cpu list format, e.g.: 0-7,16-23
+std::vector<int> ThreadPlacement::readCpuList(const std::string& fileName)
+{
+    std::vector<int> cpus;
+    std::ifstream inFile(fileName.c_str());
+    std::string line;
+    if(!inFile.is_open() || !std::getline(inFile, line))
+    {
+        return cpus;
+    }
+    std::istringstream lineStream(line);
+    std::string range;
+    while(std::getline(lineStream, range, ','))
+    {
+        std::size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = ((dash == std::string::npos) ? first : std::atoi(range.c_str() + dash + 1));
+        for(int i=first; i<=last; ++i)
+        {
+            cpus.push_back(i);
+        }
+    }
+    return cpus;
+}
+
+int ThreadPlacement::readIntFromFile(const std::string& fileName, int defaultValue)
+{
+    std::ifstream inFile(fileName.c_str());
+    int value = defaultValue;
+    if(!inFile.is_open() || !(inFile >> value))
+    {
+        return defaultValue;
+    }
+    return value;
+}
+
+}
@@ -0,0 +1,93 @@
+/***************************************************************************//**
+********************************************************************************
+**
+** @file ThreadPlacement.h
+** @author James Till Matta
+** @date 11 July, 2016
+** @brief
+**
+** @copyright Copyright (C) 2016 James Till Matta
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+**
+** @details Definition file for the ThreadPlacement class
+**
+********************************************************************************
+*******************************************************************************/
+#ifndef ORCHID_SRC_UTILITY_THREADPLACEMENT_H
+#define ORCHID_SRC_UTILITY_THREADPLACEMENT_H
+// includes for C system headers
+// includes for C++ system headers
+#include<string>
+#include<vector>
+// includes from other libraries
+// includes from ORCHID
+#include"Utility/OrchidLogger.h"
+
+namespace Utility
+{
+
+//Works out where the readout, parsing and writing threads should live
+//The A3818 cards are found through the a3818 driver entries in sysfs, from
+//  those we get the NUMA node the card hangs off of and the cpus servicing its
+//  interrupt. Each link's readout thread is given a core on the card's node
+//  that is not handling the card interrupt, processing threads get the
+//  remaining cores of that node first and then the cores of the other nodes
+//In acquire mode processing cpu 0 goes to the thread that parses, sorts,
+//  filters and writes the link 0 transfers, the command and metrics helpers
+//  take the next ones
+//Memory placement relies on the kernel's first touch policy, so buffers for a
+//  thread must be allocated (and touched) by that thread after it is pinned
+class ThreadPlacement
+{
+public:
+    ThreadPlacement(int numberOfLinks, int linksPerCard);
+    ~ThreadPlacement(){}
+
+    void discoverTopology();
+    void logLayout();
+
+    int getLinkNumaNode(int link);
+    //throws if the link is not one of the links the placement was built for
+    int getReadoutCpu(int link);
+    int getProcessingCpu(int index);
+
+    //these pin the calling thread, they return false (and log) on failure
+    bool pinToReadoutCpu(int link);
+    bool pinToProcessingCpu(int index);
+    //for threads that are handed a cpu number rather than the placement, a
+    //negative cpu number lets the thread run anywhere again
+    static bool pinCallingThread(int cpu);
+
+    //allocates a buffer and touches every page from the calling thread so
+    //that it is backed by memory on the calling thread's node
+    static char* allocateLocalBuffer(std::size_t size);
+
+private:
+    void findCards();
+    void findCardIrqCpus(const std::string& devPath, std::vector<int>& irqCpus);
+    void buildLayout();
+    std::vector<int> readCpuList(const std::string& fileName);
+    int readIntFromFile(const std::string& fileName, int defaultValue);
+
+    int numLinks;
+    int linksPerCardCount;
+    int numNodes;
+    //per card information, in the order the driver presents the cards
+    std::vector<std::string> cardAddresses;
+    std::vector<int> cardNodes;
+    std::vector<std::vector<int> > cardIrqCpus;
+    //per node list of online cpus
+    std::vector<std::vector<int> > nodeCpus;
+    //the layout that was chosen
+    std::vector<int> readoutCpus;
+    std::vector<int> processingCpus;
+
+    boost::log::sources::severity_logger_mt<LogSeverity>& lg;
+};
+
+}
+
+#endif //ORCHID_SRC_UTILITY_THREADPLACEMENT_H
@@ -10,6 +10,7 @@ HFIR background monitoring wall.
 #include<algorithm>
 #include<iostream>
 #include<iomanip>
+#include<cstdlib>
 // includes from other libraries
 #define BOOST_LOG_DYN_LINK 1
 #include<boost/log/utility/setup.hpp>
@@ -20,6 +21,20 @@ HFIR background monitoring wall.
 // includes from ORCHID
 // ORCHID device objects
 #include"Digitizer/Vx1730Digitizer.h"
+// ORCHID utilities
+#include"Utility/ThreadPlacement.h"
+// ORCHID acquisition and event chain
+#include"Acquisition/ReadoutLoop.h"
+#include"Control/CommandFifoReader.h"
+#include"Filter/ChainConfig.h"
+// ORCHID test modes
+#include"Testing/SaturationSearch.h"
+#include"Testing/LinkSnapshot.h"
+#include"Calibration/ChannelCalibration.h"
+#include"Metrics/MetricsServer.h"
+#include"Testing/AllocationCheck.h"
+#include"Testing/FilterCheck.h"
+#include"Testing/ParserCheck.h"
 
 int main(int argc, char* argv[])
 {
@@ -45,9 +60,205 @@ int main(int argc, char* argv[])
     boost::log::sources::severity_logger_mt<LogSeverity>& lg = OrchidLog::get();
     BOOST_LOG_SEV(lg, Information)  << "\n\n Starting up!\n" << std::flush;
     
-    Digitizer::Vx1730Digitizer* digi = new Digitizer::Vx1730Digitizer();
-    //digi->readDigitizer();
-    digi->clearDigitizer();
+    //the first argument picks what we do, by default just clear the digitizer
+    std::string mode("clear");
+    if(argc > 1)
+    {
+        mode = argv[1];
+    }
+    
+    //work out where things should run relative to the A3818, the link modes
+    //need a readout core for every link up to the highest one they use and
+    //calibrate runs every link from 0 up to the count it is given
+    int numLinks = 1;
+    if((mode == "snapshot") || (mode == "configure"))
+    {
+        numLinks = (((argc > 2) ? std::atoi(argv[2]) : 0) + 1);
+    }
+    else if(mode == "calibrate")
+    {
+        numLinks = ((argc > 2) ? std::atoi(argv[2]) : 1);
+    }
+    Utility::ThreadPlacement placement(((numLinks > 0) ? numLinks : 1), 4);
+    placement.discoverTopology();
+    placement.logLayout();
+    
+    if(mode == "snapshot")
+    {
+        //optional arguments: optical link number, number of boards on the link
+        //the link workers do the talking, this thread only waits on them
+        int linkNum = ((argc > 2) ? std::atoi(argv[2]) : 0);
+        int numBoards = ((argc > 3) ? std::atoi(argv[3]) : 1);
+        placement.pinToProcessingCpu(0);
+        Testing::LinkSnapshot snapshot(linkNum, numBoards, &placement);
+        snapshot.takeSnapshot();
+        BOOST_LOG_SEV(lg, Information)  << "\nORCHID has successfully shut down, have a nice day! :-)\n\n" << std::flush;
+        return 0;
+    }
+    
+    if(mode == "configure")
+    {
+        //optional arguments: optical link number, number of boards on the link,
+        //register image file to load onto them
+        int linkNum = ((argc > 2) ? std::atoi(argv[2]) : 0);
+        int numBoards = ((argc > 3) ? std::atoi(argv[3]) : 1);
+        std::string imageFile((argc > 4) ? argv[4] : "calibration.regs");
+        placement.pinToProcessingCpu(0);
+        Testing::LinkSnapshot linkConfig(linkNum, numBoards, &placement);
+        if(linkConfig.applyRegisterImage(imageFile) != 0)
+        {
+            BOOST_LOG_SEV(lg, Error) << "Snapshot: Some Registers Did Not Read Back As Written";
+            return 1;
+        }
+        BOOST_LOG_SEV(lg, Information)  << "\nORCHID has successfully shut down, have a nice day! :-)\n\n" << std::flush;
+        return 0;
+    }
+    
+    if(mode == "selfcheck")
+    {
+        //hardware free checks of the event chain stages
+        Testing::ParserCheck parserCheck;
+        Testing::FilterCheck filterCheck;
+        bool parserPassed = parserCheck.runChecks();
+        bool filterPassed = filterCheck.runChecks();
+        if(!parserPassed || !filterPassed)
+        {
+            BOOST_LOG_SEV(lg, Error) << "Self Check: FAILED";
+            return 1;
+        }
+        BOOST_LOG_SEV(lg, Information) << "Self Check: All Checks Passed";
+        BOOST_LOG_SEV(lg, Information)  << "\nORCHID has successfully shut down, have a nice day! :-)\n\n" << std::flush;
+        return 0;
+    }
+    
+    if(mode == "calibrate")
+    {
+        //optional arguments: number of optical links, number of boards on each
+        //link, target baseline in ADC counts, target noise trigger rate in Hz,
+        //and the register image file to write, all links run at once
+        int boardsPerLink = ((argc > 3) ? std::atoi(argv[3]) : 1);
+        double baselineTarget = ((argc > 4) ? std::atof(argv[4]) : 15000.0);
+        double rateTarget = ((argc > 5) ? std::atof(argv[5]) : 1.0);
+        std::string imageFile((argc > 6) ? argv[6] : "calibration.regs");
+        //the link workers pull the data, this thread parses it
+        placement.pinToProcessingCpu(0);
+        Calibration::ChannelCalibration calibration(numLinks, boardsPerLink, &placement);
+        calibration.setTargets(baselineTarget, rateTarget);
+        calibration.runCalibration();
+        calibration.writeRegisterImage(imageFile);
+        BOOST_LOG_SEV(lg, Information)  << "\nORCHID has successfully shut down, have a nice day! :-)\n\n" << std::flush;
+        return 0;
+    }
+    
+    //from here on this thread does all the talking to the digitizer, so it
+    //takes the link 0 readout core before the digitizer is built, anything
+    //else that runs is given a processing core, the nearest one going to the
+    //thread that parses and writes what the readout pulls
+    placement.pinToReadoutCpu(0);
+    Digitizer::Vx1730Digitizer digitizer;
+    Digitizer::Vx1730Digitizer* digi = &digitizer;
+    if(mode == "clear")
+    {
+        digi->clearDigitizer();
+    }
+    else if(mode == "read")
+    {
+        digi->readDigitizer();
+    }
+    else if(mode == "saturate-swtrg")
+    {
+        //optional arguments: start rate, max rate, step factor (rates in Hz),
+        //output file for the events read during the search
+        double startRate = ((argc > 2) ? std::atof(argv[2]) : 100.0);
+        double maxRate = ((argc > 3) ? std::atof(argv[3]) : 1.0e6);
+        double stepFactor = ((argc > 4) ? std::atof(argv[4]) : 2.0);
+        std::string outFile((argc > 5) ? argv[5] : "saturation.dat");
+        digi->openDigitizer();
+        Testing::SaturationSearch search(digi, outFile);
+        search.setProcessingCpu(placement.getProcessingCpu(0));
+        search.runSoftwareTriggerScan(startRate, maxRate, stepFactor);
+        digi->closeDigitizer();
+    }
+    else if(mode == "saturate-indtrg")
+    {
+        //optional arguments: start rate, max rate, step factor (rates in Hz),
+        //channel to trigger (-1 for all channels at once through the broadcast
+        //address), output file for the events read during the search
+        double startRate = ((argc > 2) ? std::atof(argv[2]) : 100.0);
+        double maxRate = ((argc > 3) ? std::atof(argv[3]) : 1.0e6);
+        double stepFactor = ((argc > 4) ? std::atof(argv[4]) : 2.0);
+        int channel = ((argc > 5) ? std::atoi(argv[5]) : -1);
+        std::string outFile((argc > 6) ? argv[6] : "saturation.dat");
+        digi->openDigitizer();
+        Testing::SaturationSearch search(digi, outFile);
+        search.setProcessingCpu(placement.getProcessingCpu(0));
+        search.runIndividualTriggerScan(startRate, maxRate, stepFactor, channel);
+        digi->closeDigitizer();
+    }
+    else if(mode == "saturate-thresh")
+    {
+        //optional arguments: start threshold, stop threshold, step size (ADC
+        //units), output file for the events read during the search
+        unsigned int startThresh = static_cast<unsigned int>((argc > 2) ? std::atoi(argv[2]) : 1000);
+        unsigned int stopThresh = static_cast<unsigned int>((argc > 3) ? std::atoi(argv[3]) : 10);
+        unsigned int stepSize = static_cast<unsigned int>((argc > 4) ? std::atoi(argv[4]) : 10);
+        std::string outFile((argc > 5) ? argv[5] : "saturation.dat");
+        digi->openDigitizer();
+        Testing::SaturationSearch search(digi, outFile);
+        search.setProcessingCpu(placement.getProcessingCpu(0));
+        search.runThresholdScan(startThresh, stopThresh, stepSize);
+        digi->closeDigitizer();
+    }
+    else if(mode == "acquire")
+    {
+        //optional arguments: run length in seconds, output file, command fifo,
+        //loopback port for the metrics endpoint, filter and reducer config
+        //file (the default one may be absent, a named one must exist)
+        double runTime = ((argc > 2) ? std::atof(argv[2]) : 60.0);
+        std::string outFile((argc > 3) ? argv[3] : "digitizerTester.dat");
+        std::string cmdFifo((argc > 4) ? argv[4] : "digitizerTester.cmd");
+        int metricsPort = ((argc > 5) ? std::atoi(argv[5]) : 9105);
+        std::string filterFile((argc > 6) ? argv[6] : "digitizerTester.filter");
+        Filter::ChainConfig chainConfig;
+        chainConfig.readFile(filterFile, (argc > 6));
+        chainConfig.logSettings();
+        Metrics::MetricsServer metricsServer(metricsPort);
+        metricsServer.setCpu(placement.getProcessingCpu(2));
+        metricsServer.start();
+        Digitizer::LiveUpdateQueue updateQueue;
+        Control::CommandFifoReader cmdReader(cmdFifo, &updateQueue);
+        cmdReader.setCpu(placement.getProcessingCpu(1));
+        cmdReader.start();
+        digi->openDigitizer();
+        //the processing thread builds the chain (see Acquisition::EventChain)
+        //on its own cpu and applies the config to it before the board starts
+        Acquisition::ReadoutLoop readout(digi, outFile, &chainConfig, &updateQueue);
+        readout.setProcessingCpu(placement.getProcessingCpu(0));
+        readout.run(runTime);
+        digi->closeDigitizer();
+        cmdReader.stop();
+        metricsServer.stop();
+        readout.getChain()->getSpectra().writeSpectra(outFile + ".spectra");
+    }
+    else if(mode == "alloccheck")
+    {
+        //optional arguments: what to run (replay or readout), seconds to run
+        //after the warm up, output file
+        std::string source((argc > 2) ? argv[2] : "replay");
+        double runTime = ((argc > 3) ? std::atof(argv[3]) : 10.0);
+        std::string outFile((argc > 4) ? argv[4] : "/dev/null");
+        Testing::AllocationCheck check(5.0, runTime);
+        bool passed = ((source == "readout") ? check.runReadout(digi, outFile, placement.getProcessingCpu(0)) : check.runReplay(outFile));
+        if(!passed)
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        BOOST_LOG_SEV(lg, Error) << "Unknown mode: " << mode << ", expected one of: clear, read, snapshot, configure, calibrate, selfcheck, acquire, alloccheck, saturate-swtrg, saturate-indtrg, saturate-thresh";
+        return 1;
+    }
     
     BOOST_LOG_SEV(lg, Information)  << "\nORCHID has successfully shut down, have a nice day! :-)\n\n" << std::flush;
 